@@ -11,6 +11,17 @@
 
 #include <chrono>
 
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
 #define steps_per_mm 40
 
 //#define width 577
@@ -57,6 +68,182 @@ double steps2mm(int steps)
     return double(steps) / double(steps_per_mm);
 }
 
+// binäres bbf (beschrieben in brunoSrc/bbfFormat.hpp): header, danach pro Befehl zwei varints mit den Deltas in Schritten
+// im Schrittplan (step plan) sind die Werte die Seillängen links und rechts statt x und y,
+// nach dem header folgt dort noch der Offset (x und y in Schritten), für den die Seillängen berechnet wurden
+const unsigned char bbf_magic[4] = { 'B', 'B', 'F', 1 };
+const unsigned char step_plan_magic[4] = { 'B', 'B', 'S', 1 };
+const size_t bbf_header_size = 36;
+const size_t step_plan_header_size = 44;
+const uint64_t bbf_unknown_count = ~uint64_t(0); // command_count eines Streams: die Befehle enden mit dem Stream
+
+struct bbf_header
+{
+    uint32_t steps_per_unit; // steps_per_mm, mit dem die Datei erstellt wurde
+    int32_t board_width;
+    int32_t min_x;
+    int32_t min_y;
+    int32_t max_x;
+    int32_t max_y;
+    uint64_t command_count;
+    int32_t offset_x; // nur im Schrittplan, sonst 0
+    int32_t offset_y;
+};
+
+uint64_t load_little_endian(const unsigned char* data, int bytes)
+{
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; i--)
+    {
+        value = value << 8 | data[i];
+    }
+    return value;
+}
+
+// data muss step_plan_header_size bytes lang sein, wenn step_plan gesetzt ist, sonst bbf_header_size
+bbf_header read_bbf_header(const unsigned char* data, bool step_plan)
+{
+    bbf_header header;
+    header.steps_per_unit = load_little_endian(data + 4, 4);
+    header.board_width = int32_t(load_little_endian(data + 8, 4));
+    header.min_x = int32_t(load_little_endian(data + 12, 4));
+    header.min_y = int32_t(load_little_endian(data + 16, 4));
+    header.max_x = int32_t(load_little_endian(data + 20, 4));
+    header.max_y = int32_t(load_little_endian(data + 24, 4));
+    header.command_count = load_little_endian(data + 28, 8);
+    header.offset_x = step_plan ? int32_t(load_little_endian(data + 36, 4)) : 0;
+    header.offset_y = step_plan ? int32_t(load_little_endian(data + 40, 4)) : 0;
+    return header;
+}
+
+// liest varint ab pos (7 bit pro byte, höchstes bit gesetzt wenn weitere folgen), false wenn die Datei vorher endet
+bool read_varint(const unsigned char* data, size_t size, size_t &pos, uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < size; shift += 7)
+    {
+        unsigned char byte = data[pos++];
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// 0, 1, 2, 3, 4, ... -> 0, -1, 1, -2, 2, ...
+int64_t unzigzag(uint64_t value)
+{
+    return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+// liest bbf blockweise aus einem Dateideskriptor (stdin oder Socket), so wie die Daten ankommen
+class bbf_stream
+{
+    int fd;
+    unsigned char buffer[4096];
+    size_t pos = 0;
+    size_t size = 0;
+    bool fill(size_t count);
+public:
+    bbf_stream(int);
+    bool starts_with(const unsigned char*, size_t);
+    bool read_bytes(unsigned char*, size_t);
+    bool read_varint(uint64_t &);
+    bool read_line(std::string &);
+};
+
+bbf_stream::bbf_stream(int fd)
+    : fd(fd)
+{
+}
+
+// liest nach, bis mindestens count bytes im Puffer sind, false wenn der Stream vorher endet
+bool bbf_stream::fill(size_t count)
+{
+    std::memmove(this->buffer, this->buffer + this->pos, this->size - this->pos);
+    this->size -= this->pos;
+    this->pos = 0;
+    while (this->size < count)
+    {
+        ssize_t received = read(this->fd, this->buffer + this->size, sizeof(this->buffer) - this->size);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false;
+        this->size += received;
+    }
+    return true;
+}
+
+// prüft den Anfang des Streams, ohne ihn zu verbrauchen
+bool bbf_stream::starts_with(const unsigned char* magic, size_t length)
+{
+    if (this->size - this->pos < length && !this->fill(length)) return false;
+    return std::memcmp(this->buffer + this->pos, magic, length) == 0;
+}
+
+bool bbf_stream::read_bytes(unsigned char* destination, size_t count)
+{
+    if (this->size - this->pos < count && !this->fill(count)) return false;
+    std::memcpy(destination, this->buffer + this->pos, count);
+    this->pos += count;
+    return true;
+}
+
+// wie read_varint() für Dateien
+bool bbf_stream::read_varint(uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (this->pos == this->size && !this->fill(1)) return false;
+        unsigned char byte = this->buffer[this->pos++];
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// liest eine Zeile (ohne '\n'), false wenn der Stream zu Ende ist
+bool bbf_stream::read_line(std::string &line)
+{
+    line.clear();
+    while (true)
+    {
+        if (this->pos == this->size && !this->fill(1)) return !line.empty();
+        const unsigned char* begin = this->buffer + this->pos;
+        const unsigned char* newline = static_cast<const unsigned char*>(std::memchr(begin, '\n', this->size - this->pos));
+        if (newline != nullptr)
+        {
+            line.append(reinterpret_cast<const char*>(begin), newline - begin);
+            this->pos += newline - begin + 1;
+            return true;
+        }
+        line.append(reinterpret_cast<const char*>(begin), this->size - this->pos);
+        this->pos = this->size;
+    }
+}
+
+// wartet an der UNIX socket socket_path auf eine Verbindung, gibt deren Dateideskriptor zurück (-1 bei Fehler)
+int accept_unix_socket(const std::string &socket_path)
+{
+    sockaddr_un address = {};
+    if (socket_path.size() >= sizeof(address.sun_path)) return -1;
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, socket_path.c_str());
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0) return -1;
+    unlink(socket_path.c_str()); // socket von einem vorherigen Lauf
+    if (bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(server, 1) < 0)
+    {
+        close(server);
+        return -1;
+    }
+    std::cout << "warte auf Verbindung an " << socket_path << "\n";
+    int connection = accept(server, nullptr, nullptr);
+    close(server);
+    unlink(socket_path.c_str());
+    return connection;
+}
+
 // Schrittmotor Klasse
 class stepper_motor
 {
@@ -124,8 +311,18 @@ public:
     plotter (stepper_motor &, stepper_motor &);
     void setPen(int);
     void go2(double, double, int);
+    void step_to(int, int);
     Coord_mm get_position_mm();
+    Coord_mm cables2coord(double, double);
+    bool in_bounds(Coord_mm);
+    void draw(std::string, double, double, int);
     void draw_bbf(std::string, double, double, int);
+    void draw_text_bbf(std::string, double, double, int);
+    void draw_binary_bbf(const unsigned char*, size_t, double, double, int, bool);
+    void draw_bbf_stream(int, double, double, int);
+    bool check_bbf_header(const bbf_header &, bool, double, double);
+    void move_binary(int64_t, int64_t, int, bool, double, double, double);
+    void abort_out_of_bounds(uint64_t);
     double width;
     void setup();
     void end();
@@ -192,49 +389,45 @@ void plotter::go2(double x, double y, int penMode = 0)
 
     int steps_left = mm2steps(sqrt(x * x + y * y)); //total cable step
     int steps_right = mm2steps(sqrt((this->width - x) * (this->width - x) + y * y));
-    int delta_l = steps_left - this->l.current_step;
-    int delta_r = steps_right - this->r.current_step;
-
-    //double ratio = std::abs(double(delta_l)) / std::abs(double(delta_r));
-
-    if(std::abs(delta_l) > std::abs(delta_r))
-    {
-        double ratio = std::abs(double(delta_l)) / std::abs(double(delta_r));
-        double counter = 0;
-        while(this->l.current_step != steps_left)
-        {
-            this->l.step(delta_l);
-            counter++;
+    this->step_to(steps_left, steps_right);
+}
 
-            if (counter > ratio)
-            {
-                r.step(delta_r, 0);
-                counter -= ratio;
-            }
-        }
-    }
-    else
+// bewegt beide Motoren zu den Seillängen in Schritten, nur mit Ganzzahlen (Bresenham):
+// der Motor mit mehr Schritten macht jeden Schritt, der andere immer dann, wenn der Fehler die Hälfte überschreitet
+void plotter::step_to(int steps_left, int steps_right)
+{
+    int delta_l = steps_left - int(this->l.current_step);
+    int delta_r = steps_right - int(this->r.current_step);
+
+    bool left_major = std::abs(delta_l) > std::abs(delta_r);
+    stepper_motor &major = left_major ? this->l : this->r;
+    stepper_motor &minor = left_major ? this->r : this->l;
+    int major_delta = left_major ? delta_l : delta_r;
+    int minor_delta = left_major ? delta_r : delta_l;
+    int major_steps = std::abs(major_delta);
+    int minor_steps = std::abs(minor_delta);
+
+    int error = 0;
+    for (int i = 0; i < major_steps; i++)
     {
-        double ratio = std::abs(double(delta_r)) / std::abs(double(delta_l));
-        double counter = 0;
-        while(this->r.current_step != steps_right)
+        major.step(major_delta);
+        error += minor_steps;
+        if (2 * error >= major_steps)
         {
-            r.step(delta_r);
-            counter++;
-
-            if (counter > ratio)
-            {
-                l.step(delta_l, 0);
-                counter -= ratio;
-            }
+            minor.step(minor_delta, 0);
+            error -= major_steps;
         }
     }
 }
 
 Coord_mm plotter::get_position_mm()
 {
-    double S1 = steps2mm(this->l.current_step);
-    double S2 = steps2mm(this->r.current_step);
+    return this->cables2coord(steps2mm(this->l.current_step), steps2mm(this->r.current_step));
+}
+
+// Position zu den Seillängen S1 (links) und S2 (rechts) in mm
+Coord_mm plotter::cables2coord(double S1, double S2)
+{
     double b = this->width;
     double x = (b * b + S1 * S1 - S2 * S2) / (2 * b);
     double y = sqrt(S1 * S1 - x * x);
@@ -243,15 +436,293 @@ Coord_mm plotter::get_position_mm()
     return {x, y};
 }
 
+// dieselben Grenzen wie beim Prüfen der Dateien (auch false für nicht erreichbare Punkte, deren y NaN ist)
+bool plotter::in_bounds(Coord_mm point)
+{
+    return point.x <= this->width - 5 && point.x >= 5 && point.y >= width / 4;
+}
+
+// source "-" liest bbf von stdin, "unix:<pfad>" von einer UNIX socket, sonst wird die Datei <source>.bbf gezeichnet.
+// aus stdin und der socket wird gezeichnet, sobald die ersten Befehle ankommen
+void plotter::draw(std::string source, double offset_x = 0, double offset_y = 0, int start_line = 0)
+{
+    if (source == "-")
+    {
+        std::cout << "draw stdin\n";
+        this->draw_bbf_stream(STDIN_FILENO, offset_x, offset_y, start_line);
+    }
+    else if (source.compare(0, 5, "unix:") == 0)
+    {
+        int connection = accept_unix_socket(source.substr(5));
+        if (connection < 0)
+        {
+            std::cout << "Error: socket " << source.substr(5) << " nicht verfügbar\n";
+            return;
+        }
+        this->draw_bbf_stream(connection, offset_x, offset_y, start_line);
+        close(connection);
+    }
+    else
+    {
+        this->draw_bbf(source + ".bbf", offset_x, offset_y, start_line);
+    }
+}
+
 
 void plotter::draw_bbf(std::string path, double offset_x = 0, double offset_y = 0, int start_line = 0)
 {
-    auto start = std::chrono::steady_clock::now();
     std::cout << "draw " << path << "\n"
               << "x offset: " << offset_x << "\n"
               << "y offset: " << offset_y << "\n"
               << "starting at Line " << start_line << "\n";
 
+    // Datei wird per mmap eingeblendet, damit binäres bbf ohne Kopie gelesen wird
+    int file = open(path.c_str(), O_RDONLY);
+    struct stat file_stat;
+    if (file < 0 || fstat(file, &file_stat) < 0)
+    {
+        std::cout << "Error: Datei " << path << " nicht lesbar\n";
+        if (file >= 0) close(file);
+        return;
+    }
+    size_t size = file_stat.st_size;
+    const unsigned char* data = nullptr;
+    if (size > 0)
+    {
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapped != MAP_FAILED) data = static_cast<const unsigned char*>(mapped);
+    }
+    close(file);
+
+    if (data != nullptr && size >= bbf_header_size && std::memcmp(data, bbf_magic, sizeof(bbf_magic)) == 0)
+    {
+        this->draw_binary_bbf(data, size, offset_x, offset_y, start_line, false);
+    }
+    else if (data != nullptr && size >= step_plan_header_size && std::memcmp(data, step_plan_magic, sizeof(step_plan_magic)) == 0)
+    {
+        this->draw_binary_bbf(data, size, offset_x, offset_y, start_line, true);
+    }
+    else
+    {
+        this->draw_text_bbf(path, offset_x, offset_y, start_line);
+    }
+    if (data != nullptr) munmap(const_cast<unsigned char*>(data), size);
+}
+
+// step_plan: die Datei enthält Seillängen statt Punkte, die ohne Umrechnung angefahren werden
+void plotter::draw_binary_bbf(const unsigned char* data, size_t size, double offset_x, double offset_y, int start_line, bool step_plan)
+{
+    auto start = std::chrono::steady_clock::now();
+    bbf_header header = read_bbf_header(data, step_plan);
+    double mm_per_step = 1.0 / header.steps_per_unit;
+    if (!this->check_bbf_header(header, step_plan, offset_x, offset_y)) return;
+
+    size_t pos = step_plan ? step_plan_header_size : bbf_header_size;
+    uint64_t first_line = start_line > 0 ? start_line : 0; // wie current_line ohne Vorzeichen
+    int64_t x = 0; // im Schrittplan die Seillänge links
+    int64_t y = 0; // im Schrittplan die Seillänge rechts
+    for (uint64_t current_line = 0; current_line < header.command_count; current_line++)
+    {
+        uint64_t first, second;
+        if (!read_varint(data, size, pos, first) || !read_varint(data, size, pos, second))
+        {
+            // ein gespeicherter Stream endet ohne Anzahl im header einfach mit der Datei
+            if (header.command_count != bbf_unknown_count)
+            {
+                std::cout << "Error: bbf Datei endet nach " << current_line << " von " << header.command_count << " Befehlen\n";
+            }
+            break;
+        }
+        x += unzigzag(first >> 1);
+        y += unzigzag(second);
+        int g = first & 1;
+        if(current_line >= first_line)
+        {
+            // der header kann falsch sein, daher wird auch hier jeder Befehl vor dem Anfahren geprüft
+            Coord_mm point = step_plan ? this->cables2coord(x * mm_per_step, y * mm_per_step)
+                                       : Coord_mm{ x * mm_per_step + offset_x, y * mm_per_step + offset_y };
+            if (!this->in_bounds(point))
+            {
+                this->abort_out_of_bounds(current_line);
+                return;
+            }
+            std::cout << "line: " << current_line << " ";
+            if(current_line == first_line) g = 0;
+            this->move_binary(x, y, g, step_plan, mm_per_step, offset_x, offset_y);
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "Elapsed time in seconds : "
+              << std::chrono::duration_cast<std::chrono::seconds>(end - start).count() << " sec\n";
+}
+
+// gibt den header aus und prüft ihn, false wenn nicht gezeichnet werden darf
+bool plotter::check_bbf_header(const bbf_header &header, bool step_plan, double offset_x, double offset_y)
+{
+    double mm_per_step = 1.0 / header.steps_per_unit;
+    std::cout << (step_plan ? "Schrittplan" : "binäres bbf") << " mit ";
+    if (header.command_count == bbf_unknown_count) std::cout << "beliebig vielen";
+    else std::cout << header.command_count;
+    std::cout << " Befehlen, erstellt für " << header.board_width * mm_per_step << "mm Breite\n";
+
+    if (step_plan)
+    {
+        // die Seillängen passen nur zu der Breite und dem Offset, für die sie berechnet wurden, und lassen sich nicht verschieben
+        if (header.steps_per_unit != steps_per_mm || header.board_width != mm2steps(this->width))
+        {
+            std::cout << "Error: Schrittplan wurde für andere Breite oder Schritte pro mm erstellt\n";
+            return false;
+        }
+        if (header.offset_x != mm2steps(offset_x) || header.offset_y != mm2steps(offset_y))
+        {
+            std::cout << "Error: Schrittplan wurde für Offset " << steps2mm(header.offset_x) << " " << steps2mm(header.offset_y)
+                      << " erstellt, nicht für " << offset_x << " " << offset_y << "\n";
+            return false;
+        }
+    }
+
+    // Grenzen werden mit der bounding box aus dem header geprüft, ohne die Datei zweimal zu lesen
+    if (header.command_count > 0)
+    {
+        if(header.max_x * mm_per_step + offset_x > this->width - 5 || header.min_x * mm_per_step + offset_x < 5)
+        {
+            std::cout << "Error: Objekt überschreitet X Grenzen\n";
+            std::cout << "Error: mission abborted due to boundary issues\n";
+            return false;
+        }
+        if(header.min_y * mm_per_step + offset_y < width / 4)
+        {
+            std::cout << "Error: Objekt zu weit oben\n";
+            std::cout << "Error: mission abborted due to boundary issues\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// fährt einen Befehl aus binärem bbf an (x und y in Schritten, im Schrittplan die Seillängen)
+void plotter::move_binary(int64_t x, int64_t y, int g, bool step_plan, double mm_per_step, double offset_x, double offset_y)
+{
+    if (step_plan)
+    {
+        std::cout << "PenMode " << g << " to L: " << x << " R: " << y << "\n";
+        this->setPen(g);
+        this->step_to(x, y);
+    }
+    else
+    {
+        this->go2(x * mm_per_step + offset_x, y * mm_per_step + offset_y, g);
+    }
+}
+
+// bricht ab, bevor ein Punkt außerhalb der Grenzen angefahren wird: Stift hoch und stehen bleiben
+void plotter::abort_out_of_bounds(uint64_t current_line)
+{
+    std::cout << "Error: Befehl " << current_line << " liegt außerhalb der Grenzen\n";
+    std::cout << "Error: mission abborted due to boundary issues\n";
+    this->setPen(0);
+}
+
+// zeichnet bbf aus einem Stream, während es ankommt: der Stream kann nicht zweimal gelesen werden,
+// daher wird jeder Befehl vor dem Anfahren geprüft (binäres bbf wird zusätzlich vorher mit dem header geprüft)
+void plotter::draw_bbf_stream(int fd, double offset_x, double offset_y, int start_line)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::cout << "x offset: " << offset_x << "\n"
+              << "y offset: " << offset_y << "\n"
+              << "starting at Line " << start_line << "\n";
+
+    bbf_stream input(fd);
+    bool step_plan = input.starts_with(step_plan_magic, sizeof(step_plan_magic));
+    uint64_t current_line = 0;
+    uint64_t first_line = start_line > 0 ? start_line : 0; // wie current_line ohne Vorzeichen
+    if (step_plan || input.starts_with(bbf_magic, sizeof(bbf_magic)))
+    {
+        unsigned char header_data[step_plan_header_size];
+        if (!input.read_bytes(header_data, step_plan ? step_plan_header_size : bbf_header_size))
+        {
+            std::cout << "Error: Stream endet im header\n";
+            return;
+        }
+        bbf_header header = read_bbf_header(header_data, step_plan);
+        double mm_per_step = 1.0 / header.steps_per_unit;
+        if (!this->check_bbf_header(header, step_plan, offset_x, offset_y)) return;
+
+        int64_t x = 0; // im Schrittplan die Seillänge links
+        int64_t y = 0; // im Schrittplan die Seillänge rechts
+        for (; current_line < header.command_count; current_line++)
+        {
+            uint64_t first, second;
+            if (!input.read_varint(first) || !input.read_varint(second))
+            {
+                if (header.command_count != bbf_unknown_count)
+                {
+                    std::cout << "Error: Stream endet nach " << current_line << " von " << header.command_count << " Befehlen\n";
+                }
+                break;
+            }
+            x += unzigzag(first >> 1);
+            y += unzigzag(second);
+            int g = first & 1;
+            if(current_line >= first_line)
+            {
+                Coord_mm point = step_plan ? this->cables2coord(x * mm_per_step, y * mm_per_step)
+                                           : Coord_mm{ x * mm_per_step + offset_x, y * mm_per_step + offset_y };
+                if (!this->in_bounds(point))
+                {
+                    this->abort_out_of_bounds(current_line);
+                    return;
+                }
+                std::cout << "line: " << current_line << " ";
+                if(current_line == first_line) g = 0;
+                this->move_binary(x, y, g, step_plan, mm_per_step, offset_x, offset_y);
+            }
+        }
+    }
+    else
+    {
+        std::string line;
+        while (input.read_line(line))
+        {
+            int g;
+            double x, y;
+            int values = sscanf(line.c_str(), "%d %lf %lf", &g, &x, &y);
+            if (values == EOF) continue; // leere Zeile
+            if (values != 3)
+            {
+                std::cout << "Error: Zeile " << current_line << " ist kein bbf Befehl\n";
+                break;
+            }
+            if(current_line >= first_line)
+            {
+                x += offset_x;
+                y += offset_y;
+                if (!this->in_bounds({ x, y }))
+                {
+                    this->abort_out_of_bounds(current_line);
+                    return;
+                }
+                std::cout << "line: " << current_line << " ";
+                if(current_line == first_line) g = 0;
+                this->go2(x, y, g);
+            }
+            current_line++;
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << current_line << " Befehle gezeichnet\n";
+    std::cout << "Elapsed time in seconds : "
+              << std::chrono::duration_cast<std::chrono::seconds>(end - start).count() << " sec\n";
+}
+
+void plotter::draw_text_bbf(std::string path, double offset_x, double offset_y, int start_line)
+{
+    auto start = std::chrono::steady_clock::now();
+
     std::ifstream bbf(path); // bbf Bruno Bashi Format
     int g;
     double x, y;
@@ -352,34 +823,30 @@ int main(int argc, char *argv[])
 
     if (argc == 1)
     {
-        std::cout << "Error: Keine Datei ausgewählt\n";
+        std::cout << "Error: Keine Datei ausgewählt (- für stdin, unix:<pfad> für eine UNIX socket)\n";
         exit(3);
     }
     else if (argc == 2)
     {
-        const std::string path = argv[1] + std::string(".bbf");
-        pltr.draw_bbf(path);
+        pltr.draw(argv[1]);
     }
     else if (argc == 3)
     {
-        const std::string path = argv[1] + std::string(".bbf");
         double x_offset = std::strtod(argv[2], nullptr);
-        pltr.draw_bbf(path, x_offset);
+        pltr.draw(argv[1], x_offset);
     }
     else if (argc == 4)
     {
-        const std::string path = argv[1] + std::string(".bbf");
         double x_offset = std::strtod(argv[2], nullptr);
         double y_offset = std::strtod(argv[3], nullptr);
-        pltr.draw_bbf(path, x_offset, y_offset);
+        pltr.draw(argv[1], x_offset, y_offset);
     }
     else if (argc == 5)
     {
-        const std::string path = argv[1] + std::string(".bbf");
         double x_offset = std::strtod(argv[2], nullptr);
         double y_offset = std::strtod(argv[3], nullptr);
         unsigned int start_line = std::atoi(argv[4]);
-        pltr.draw_bbf(path, x_offset, y_offset, start_line);
+        pltr.draw(argv[1], x_offset, y_offset, start_line);
     }
     else if (argc > 5)
     {
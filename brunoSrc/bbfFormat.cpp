@@ -0,0 +1,287 @@
+#include "bbfFormat.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <algorithm>
+#include <iterator>
+#include <charconv>
+#include <cassert>
+#include <array>
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////functions local to this file////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static std::int32_t to_steps(double mm)
+{
+	return static_cast<std::int32_t>(std::lround(mm * bbf::steps_per_mm));
+}
+
+static std::uint64_t zigzag(std::int64_t value)
+{
+	return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+static void append_varint(std::vector<unsigned char>& data, std::uint64_t value)
+{
+	while (value >= 0x80) {
+		data.push_back(static_cast<unsigned char>(value | 0x80));
+		value >>= 7;
+	}
+	data.push_back(static_cast<unsigned char>(value));
+}
+
+template<typename Int>
+static void store_little_endian(unsigned char* destination, Int value)
+{
+	const auto bits = static_cast<std::uint64_t>(value);
+	for (std::size_t i = 0; i < sizeof(Int); i++) {
+		destination[i] = static_cast<unsigned char>(bits >> (8 * i));
+	}
+}
+
+//stores header (and magic) in the first Binary_Header::size bytes of destination
+static void store_header(unsigned char* destination, const unsigned char (&magic)[4], const bbf::Binary_Header& header)
+{
+	std::copy(std::begin(magic), std::end(magic), destination);
+	store_little_endian(destination + 4, header.steps_per_mm);
+	store_little_endian(destination + 8, header.board_width);
+	store_little_endian(destination + 12, header.min_x);
+	store_little_endian(destination + 16, header.min_y);
+	store_little_endian(destination + 20, header.max_x);
+	store_little_endian(destination + 24, header.max_y);
+	store_little_endian(destination + 28, header.command_count);
+}
+
+//appends the two varints of a command moving by (delta_x, delta_y)
+static void append_command(std::vector<unsigned char>& data, std::int64_t delta_x, std::int64_t delta_y, bool pen_down)
+{
+	append_varint(data, zigzag(delta_x) << 1 | (pen_down ? 1 : 0));
+	append_varint(data, zigzag(delta_y));
+}
+
+//writes the header and every command of toolpath as the two values returned by values_of(point), see bbf::to_binary().
+//the bounding box in the header is always the one of the points (rounded to steps).
+//the commands start after header_size bytes, the bytes behind the header are left to the caller.
+template<typename Values_Of>
+static std::vector<unsigned char> encode(const Toolpath& toolpath, const unsigned char (&magic)[4], std::size_t header_size, double board_width, Values_Of values_of)
+{
+	assert(header_size >= bbf::Binary_Header::size);
+	std::vector<unsigned char> data(header_size);
+	data.reserve(header_size + 2 * toolpath.point_count());
+
+	bbf::Binary_Header header;
+	header.board_width = to_steps(board_width);
+	std::array<std::int32_t, 2> prev_values = { 0, 0 };
+	bool prev_pen_down = false;
+	auto add_command = [&](la::Board_Vec point, bool pen_down) {
+		const std::array<std::int32_t, 2> values = values_of(point);
+		if (pen_down && prev_pen_down && values == prev_values) {
+			return;
+		}
+		const std::int32_t x = to_steps(point.x);
+		const std::int32_t y = to_steps(point.y);
+		if (header.command_count == 0) {
+			header.min_x = header.max_x = x;
+			header.min_y = header.max_y = y;
+		}
+		header.min_x = std::min(header.min_x, x);
+		header.min_y = std::min(header.min_y, y);
+		header.max_x = std::max(header.max_x, x);
+		header.max_y = std::max(header.max_y, y);
+		header.command_count++;
+
+		append_command(data, std::int64_t(values[0]) - prev_values[0], std::int64_t(values[1]) - prev_values[1], pen_down);
+		prev_values = values;
+		prev_pen_down = pen_down;
+	};
+	auto go_to = [&](la::Board_Vec point) { add_command(point, false); };
+	auto draw_to = [&](la::Board_Vec point) { add_command(point, true); };
+	toolpath.replay(draw_to, go_to);
+
+	store_header(data.data(), magic, header);
+	return data;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////functions visible from the outside//////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Text_Writer::Text_Writer(const char* file_name, double precision)
+	:Text_Writer(this->file, precision)
+{
+	this->file.open(file_name, std::ios::binary);
+}
+
+Text_Writer::Text_Writer(std::ostream& stream, double precision)
+	:stream(stream), buffer(Text_Writer::capacity), precision(precision), decimals(0)
+{
+	assert(precision > 0.0);
+	//0.025 needs 3 decimals, as 1000 * 0.025 is the first integer multiple
+	for (double scaled = precision; this->decimals < 9 && std::abs(scaled - std::round(scaled)) > 1e-9 * scaled; scaled *= 10) {
+		this->decimals++;
+	}
+}
+
+Text_Writer::~Text_Writer()
+{
+	this->flush();
+}
+
+void Text_Writer::write(char character)
+{
+	if (this->size == Text_Writer::capacity) {
+		this->flush();
+	}
+	this->buffer[this->size++] = character;
+}
+
+void Text_Writer::write(std::string_view text)
+{
+	if (this->size + text.size() > Text_Writer::capacity) {
+		this->flush();
+		if (text.size() > Text_Writer::capacity) {
+			this->stream.write(text.data(), text.size());
+			return;
+		}
+	}
+	std::copy(text.begin(), text.end(), this->buffer.data() + this->size);
+	this->size += text.size();
+}
+
+void Text_Writer::write_quantised(std::int64_t quantised)
+{
+	constexpr std::size_t max_number_length = 64;
+	if (this->size + max_number_length > Text_Writer::capacity) {
+		this->flush();
+	}
+	char* const begin = this->buffer.data() + this->size;
+	char* const end = this->buffer.data() + Text_Writer::capacity;
+	char* last = std::to_chars(begin, end, quantised * this->precision, std::chars_format::fixed, this->decimals).ptr;
+	if (this->decimals > 0) {
+		while (last[-1] == '0') {
+			last--;
+		}
+		if (last[-1] == '.') {
+			last--;
+		}
+	}
+	this->size = last - this->buffer.data();
+}
+
+void Text_Writer::flush()
+{
+	this->stream.write(this->buffer.data(), this->size);
+	this->stream.flush();
+	this->size = 0;
+}
+
+std::vector<unsigned char> bbf::to_binary(const Toolpath& toolpath, double board_width)
+{
+	auto steps_of = [](la::Board_Vec point) {
+		return std::array<std::int32_t, 2>{ to_steps(point.x), to_steps(point.y) };
+	};
+	return encode(toolpath, Binary_Header::magic, Binary_Header::size, board_width, steps_of);
+}
+
+std::vector<unsigned char> bbf::to_step_plan(const Toolpath& toolpath, double motor_distance, la::Vec2D wall_offset)
+{
+	auto cable_steps_of = [motor_distance, wall_offset](la::Board_Vec point) {
+		const double x = point.x + wall_offset.x;
+		const double y = point.y + wall_offset.y;
+		return std::array<std::int32_t, 2>{ to_steps(std::hypot(x, y)), to_steps(std::hypot(motor_distance - x, y)) };
+	};
+	std::vector<unsigned char> data = encode(toolpath, Binary_Header::step_plan_magic, Binary_Header::step_plan_size, motor_distance, cable_steps_of);
+	store_little_endian(data.data() + Binary_Header::size, to_steps(wall_offset.x));
+	store_little_endian(data.data() + Binary_Header::size + 4, to_steps(wall_offset.y));
+	return data;
+}
+
+void bbf::write_binary(const Toolpath& toolpath, const char* file_name, double board_width)
+{
+	const std::vector<unsigned char> data = bbf::to_binary(toolpath, board_width);
+	std::ofstream output(file_name, std::ios::binary);
+	output.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+void bbf::write_step_plan(const Toolpath& toolpath, const char* file_name, double motor_distance, la::Vec2D wall_offset)
+{
+	const std::vector<unsigned char> data = bbf::to_step_plan(toolpath, motor_distance, wall_offset);
+	std::ofstream output(file_name, std::ios::binary);
+	output.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+void bbf::write_text(const Toolpath& toolpath, const char* file_name, double precision)
+{
+	Text_Stream output(file_name, precision);
+	auto go_to = [&output](la::Board_Vec point) { output.go_to(point); };
+	auto draw_to = [&output](la::Board_Vec point) { output.draw_to(point); };
+	toolpath.replay(draw_to, go_to);
+}
+
+bbf::Text_Stream::Text_Stream(const char* file_name, double precision)
+	:output(file_name, precision)
+{
+}
+
+bbf::Text_Stream::Text_Stream(std::ostream& stream, double precision)
+	:output(stream, precision)
+{
+}
+
+void bbf::Text_Stream::add_command(la::Board_Vec point, bool pen_down)
+{
+	const std::int64_t x = this->output.quantise(point.x);
+	const std::int64_t y = this->output.quantise(point.y);
+	if (pen_down && this->prev_pen_down && x == this->prev_x && y == this->prev_y) {
+		return;
+	}
+	this->output.write(pen_down ? "1 " : "0 ");
+	this->output.write_quantised(x);
+	this->output.write(' ');
+	this->output.write_quantised(y);
+	this->output.write('\n');
+	this->prev_x = x;
+	this->prev_y = y;
+	this->prev_pen_down = pen_down;
+}
+
+bbf::Binary_Stream::Binary_Stream(std::ostream& stream, double board_width, double board_height)
+	:stream(stream), data(Binary_Header::size)
+{
+	Binary_Header header;
+	header.board_width = to_steps(board_width);
+	header.max_x = to_steps(board_width);
+	header.max_y = to_steps(board_height);
+	header.command_count = Binary_Header::unknown_count;
+	store_header(this->data.data(), Binary_Header::magic, header);
+}
+
+bbf::Binary_Stream::~Binary_Stream()
+{
+	this->flush();
+}
+
+void bbf::Binary_Stream::add_command(la::Board_Vec point, bool pen_down)
+{
+	const std::int32_t x = to_steps(point.x);
+	const std::int32_t y = to_steps(point.y);
+	if (pen_down && this->prev_pen_down && x == this->prev_x && y == this->prev_y) {
+		return;
+	}
+	append_command(this->data, std::int64_t(x) - this->prev_x, std::int64_t(y) - this->prev_y, pen_down);
+	this->prev_x = x;
+	this->prev_y = y;
+	this->prev_pen_down = pen_down;
+}
+
+void bbf::Binary_Stream::flush()
+{
+	this->stream.write(reinterpret_cast<const char*>(this->data.data()), this->data.size());
+	this->stream.flush();
+	this->data.clear();
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <fstream>
+#include <ostream>
+#include <string_view>
+
+#include "toolpath.hpp"
+
+//writes text to a file, but collects it in a buffer first, which is handed to the file in one call whenever it is full.
+//numbers are formatted with std::to_chars(), which (unlike iostreams) does not look at locales and does not allocate.
+class Text_Writer
+{
+	std::ofstream file;		//only opened if a file name is given
+	std::ostream& stream;	//where the text ends up (file or a stream given)
+	std::vector<char> buffer;
+	std::size_t size = 0;	//used part of buffer
+	double precision;
+	int decimals;			//amount of decimals needed to write every multiple of precision
+
+public:
+	static constexpr std::size_t capacity = 1 << 16;
+
+	//numbers are written as the nearest multiple of precision (e.g. 0.025 for the steps of the plotter)
+	Text_Writer(const char* file_name, double precision);
+	Text_Writer(std::ostream& stream, double precision);
+	~Text_Writer();	//flushes
+
+	//numbers written are the same, if their quantised values are
+	std::int64_t quantise(double value) const { return std::llround(value / this->precision); }
+
+	void write(char character);
+	void write(std::string_view text);
+	void write(double number) { this->write_quantised(this->quantise(number)); }
+	void write_quantised(std::int64_t quantised);	//writes quantised * precision without trailing zeros
+
+	void flush();	//also flushes the stream, so a pipe reading the text gets it right away
+};
+
+//bbf (bruno bashi format) is what the plotter (basheySrc/stepper08.cpp) draws. it comes in two variants:
+//text: one command per line, see bffBNF.txt
+//binary: a header followed by the commands, every coordinate rounded to the steps of the plotter (see below).
+//the plotter tells both apart by the first four bytes, which can never start a text bbf.
+//the plotter also draws step plans, which are binary bbf with the cable lengths in place of the points (see bbf::to_step_plan()).
+namespace bbf {
+
+	//has to match steps_per_mm in basheySrc/stepper08.cpp
+	constexpr std::uint32_t steps_per_mm = 40;
+
+	//all numbers of the header are stored little endian, coordinates in steps (mm * steps_per_mm)
+	struct Binary_Header
+	{
+		static constexpr std::size_t size = 36;	//bytes in file
+		static constexpr std::size_t step_plan_size = 44;	//a step plan also stores the wall offset, see to_step_plan()
+		static constexpr unsigned char magic[4] = { 'B', 'B', 'F', 1 };	//last byte is version
+		static constexpr unsigned char step_plan_magic[4] = { 'B', 'B', 'S', 1 };
+
+		std::uint32_t steps_per_mm = bbf::steps_per_mm;
+		std::int32_t board_width = 0;	//width of the board the drawing was converted for
+		std::int32_t min_x = 0;			//bounding box of all points
+		std::int32_t min_y = 0;
+		std::int32_t max_x = 0;
+		std::int32_t max_y = 0;
+		std::uint64_t command_count = 0;
+
+		//command_count of a stream (see Binary_Stream): the commands end where the stream ends
+		static constexpr std::uint64_t unknown_count = ~std::uint64_t(0);
+	};
+
+	//after the header every command is stored as two varints (7 bits per byte, least significant first, highest bit set if more follow):
+	//the first is (zigzag(x - previous x) << 1) | pen_down, the second is zigzag(y - previous y).
+	//previous is (0, 0) for the first command. zigzag maps 0, -1, 1, -2, 2, ... to 0, 1, 2, 3, 4, ...
+	//a draw to command following a draw to command ending at the same point (after rounding) is dropped, as the plotter would not move.
+	//the first draw to command after a go to is always kept, so zero-length lines are still drawn as dots.
+	std::vector<unsigned char> to_binary(const Toolpath& toolpath, double board_width);
+
+	void write_binary(const Toolpath& toolpath, const char* file_name, double board_width);
+
+	//same as to_binary(), but the two values of every command are the absolute lengths of the left and the right cable in steps
+	//(the motors hang at (0, 0) and (motor_distance, 0)), so the plotter only needs integer arithmetic to move.
+	//the points are drawn shifted by wall_offset (offset_x and offset_y of the plotter), which is stored in steps
+	//as two more int32 (x, y) after the header. the plotter only draws a step plan with the offset it was computed for.
+	//board_width in the header is motor_distance, the bounding box is still the one of the points (without the offset).
+	std::vector<unsigned char> to_step_plan(const Toolpath& toolpath, double motor_distance, la::Vec2D wall_offset);
+
+	void write_step_plan(const Toolpath& toolpath, const char* file_name, double motor_distance, la::Vec2D wall_offset);
+
+	//writes toolpath as text bbf with every coordinate rounded to a multiple of precision.
+	//a draw to command following a draw to command ending at the same point (after rounding) is dropped, as in the binary variant.
+	//the first draw to command after a go to is always kept, so zero-length lines are still drawn as dots.
+	void write_text(const Toolpath& toolpath, const char* file_name, double precision = 1.0 / steps_per_mm);
+
+	//writes every command handed to it as text bbf (as write_text() does), so it can be used as sink while converting.
+	//the text is buffered until flush() is called (or the buffer is full).
+	class Text_Stream
+	{
+		Text_Writer output;
+		std::int64_t prev_x = 0;
+		std::int64_t prev_y = 0;
+		bool prev_pen_down = false;
+
+		void add_command(la::Board_Vec point, bool pen_down);
+
+	public:
+		Text_Stream(const char* file_name, double precision = 1.0 / steps_per_mm);
+		Text_Stream(std::ostream& stream, double precision = 1.0 / steps_per_mm);
+
+		void draw_to(la::Board_Vec point) { this->add_command(point, true); }
+		void go_to(la::Board_Vec point) { this->add_command(point, false); }
+
+		void flush() { this->output.flush(); }
+	};
+
+	//same as Text_Stream, but writes binary bbf. as the commands are not known in advance, the header is written first
+	//with command_count set to Binary_Header::unknown_count and the whole board (0, 0) to (board_width, board_height) as bounding box,
+	//as no point drawn by the converter lies outside of the board.
+	class Binary_Stream
+	{
+		std::ostream& stream;
+		std::vector<unsigned char> data;	//encoded, but not yet written to stream
+		std::int32_t prev_x = 0;
+		std::int32_t prev_y = 0;
+		bool prev_pen_down = false;
+
+		void add_command(la::Board_Vec point, bool pen_down);
+
+	public:
+		Binary_Stream(std::ostream& stream, double board_width, double board_height);
+		~Binary_Stream();	//flushes
+
+		void draw_to(la::Board_Vec point) { this->add_command(point, true); }
+		void go_to(la::Board_Vec point) { this->add_command(point, false); }
+
+		void flush();	//also flushes the stream
+	};
+}
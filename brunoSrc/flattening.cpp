@@ -0,0 +1,254 @@
+#include "flattening.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////functions local to this file////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//one coordinate of a cubic bezier curve written as polynomial: value(t) = a * t^3 + b * t^2 + c * t + d
+struct Polynomial
+{
+	double a, b, c, d;
+};
+
+//coefficients taken from the bernstein form: https://en.wikipedia.org/wiki/B%C3%A9zier_curve#Polynomial_form
+constexpr Polynomial polynomial_of(double start, double control_1, double control_2, double end)
+{
+	return { -start + 3 * control_1 - 3 * control_2 + end,
+	         3 * start - 6 * control_1 + 3 * control_2,
+	         -3 * start + 3 * control_1,
+	         start };
+}
+
+//coefficients of the quadratic bernstein form (start * (1 - t)^2 + 2 * control * t * (1 - t) + end * t^2), the cubic one is 0
+constexpr Polynomial polynomial_of(double start, double control, double end)
+{
+	return { 0.0,
+	         start - 2 * control + end,
+	         -2 * start + 2 * control,
+	         start };
+}
+
+void forward_differences(Polynomial x, Polynomial y, la::Board_Vec end, std::size_t steps, flatten::Point_Batch& batch)
+{
+	batch.resize(steps);
+	const double h = 1.0 / steps;
+
+	//differences of first, second and third order at t = 0, see https://en.wikipedia.org/wiki/Finite_difference
+	double x_value = x.d;
+	double x_diff_1 = x.a * h * h * h + x.b * h * h + x.c * h;
+	double x_diff_2 = 6 * x.a * h * h * h + 2 * x.b * h * h;
+	const double x_diff_3 = 6 * x.a * h * h * h;
+
+	double y_value = y.d;
+	double y_diff_1 = y.a * h * h * h + y.b * h * h + y.c * h;
+	double y_diff_2 = 6 * y.a * h * h * h + 2 * y.b * h * h;
+	const double y_diff_3 = 6 * y.a * h * h * h;
+
+	double* const xs = batch.x.data();
+	double* const ys = batch.y.data();
+	for (std::size_t i = 0; i + 1 < steps; i++) {
+		x_value += x_diff_1;
+		x_diff_1 += x_diff_2;
+		x_diff_2 += x_diff_3;
+		xs[i] = x_value;
+
+		y_value += y_diff_1;
+		y_diff_1 += y_diff_2;
+		y_diff_2 += y_diff_3;
+		ys[i] = y_value;
+	}
+	xs[steps - 1] = end.x;	//rounding errors add up while differencing, but the last point has to be exact
+	ys[steps - 1] = end.y;
+}
+
+#if defined(__AVX2__)
+//evaluates ((a * t + b) * t + c) * t + d for four values of t at once
+inline __m256d horner(const Polynomial& p, __m256d t)
+{
+	__m256d result = _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(p.a), t), _mm256_set1_pd(p.b));
+	result = _mm256_add_pd(_mm256_mul_pd(result, t), _mm256_set1_pd(p.c));
+	return _mm256_add_pd(_mm256_mul_pd(result, t), _mm256_set1_pd(p.d));
+}
+
+void polynomial_avx2(Polynomial x, Polynomial y, la::Board_Vec end, std::size_t steps, flatten::Point_Batch& batch)
+{
+	batch.resize(steps);
+	double* const xs = batch.x.data();
+	double* const ys = batch.y.data();
+
+	const __m256d step_size = _mm256_set1_pd(1.0 / steps);
+	const __m256d first_four = _mm256_set_pd(4.0, 3.0, 2.0, 1.0);	//_mm256_set_pd() expects the highest element first
+	std::size_t i = 0;
+	for (; i + 4 <= steps; i += 4) {
+		const __m256d t = _mm256_mul_pd(_mm256_add_pd(_mm256_set1_pd(static_cast<double>(i)), first_four), step_size);
+		_mm256_storeu_pd(xs + i, horner(x, t));
+		_mm256_storeu_pd(ys + i, horner(y, t));
+	}
+	for (; i < steps; i++) {
+		const double t = (i + 1) / static_cast<double>(steps);
+		xs[i] = ((x.a * t + x.b) * t + x.c) * t + x.d;
+		ys[i] = ((y.a * t + y.b) * t + y.c) * t + y.d;
+	}
+	xs[steps - 1] = end.x;
+	ys[steps - 1] = end.y;
+}
+#endif
+
+//calls fastest kernel available for polynomials
+inline void polynomial_kernel(Polynomial x, Polynomial y, la::Board_Vec end, std::size_t steps, flatten::Point_Batch& batch)
+{
+#if defined(__AVX2__)
+	polynomial_avx2(x, y, end, steps, batch);
+#else
+	forward_differences(x, y, end, steps, batch);
+#endif
+}
+
+//returns lengths of the left and the right cable with plotter at point
+inline la::Vec2D cable_lengths_at(la::Board_Vec point, double motor_distance)
+{
+	return { std::sqrt(point.x * point.x + point.y * point.y), 
+	         std::sqrt((motor_distance - point.x) * (motor_distance - point.x) + point.y * point.y) };
+}
+
+//inverse of cable_lengths_at(), same formula as plotter::get_position_mm() in basheySrc/stepper08.cpp
+inline la::Board_Vec position_at(la::Vec2D cable_lengths, double motor_distance)
+{
+	const double left = cable_lengths.x;
+	const double right = cable_lengths.y;
+	const double x = (motor_distance * motor_distance + left * left - right * right) / (2 * motor_distance);
+	return la::Board_Vec(x, std::sqrt(std::max(left * left - x * x, 0.0)));
+}
+
+//appends the points needed after start to draw the line to end (including end) to batch
+//wall_offset is where the origin of the board lies on the wall (as seen from the left motor)
+void split_cable_line(la::Board_Vec start, la::Board_Vec end, double motor_distance, la::Board_Vec wall_offset, double tolerance, 
+	std::size_t depth, flatten::Point_Batch& batch)
+{
+	constexpr std::size_t max_depth = 16;	//at most 2^16 pieces per line
+
+	//the plotter is furthest from the straight line about halfway, measured in cable lengths
+	const la::Vec2D start_lengths = cable_lengths_at(start + wall_offset, motor_distance);
+	const la::Vec2D end_lengths = cable_lengths_at(end + wall_offset, motor_distance);
+	const la::Board_Vec halfway = position_at(0.5 * (start_lengths + end_lengths), motor_distance) - wall_offset;
+
+	const la::Board_Vec direction = end - start;
+	const la::Board_Vec offset = halfway - start;
+	const double length = la::abs(direction);
+	const double deviation = length > 0.0 ? std::abs(direction.x * offset.y - direction.y * offset.x) / length : 0.0;
+
+	if (deviation > tolerance && depth < max_depth) {
+		const la::Board_Vec middle = 0.5 * (start + end);
+		split_cable_line(start, middle, motor_distance, wall_offset, tolerance, depth + 1, batch);
+		split_cable_line(middle, end, motor_distance, wall_offset, tolerance, depth + 1, batch);
+	}
+	else {
+		const std::size_t index = batch.size;
+		batch.resize(index + 1);
+		batch.x[index] = end.x;
+		batch.y[index] = end.y;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////functions visible from the outside//////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void flatten::Point_Batch::resize(std::size_t new_size)
+{
+	if (this->x.size() < new_size) {
+		this->x.resize(new_size);
+		this->y.resize(new_size);
+	}
+	this->size = new_size;
+}
+
+void flatten::cubic_direct(la::Board_Vec start, la::Board_Vec control_1, la::Board_Vec control_2, la::Board_Vec end, std::size_t steps, Point_Batch& batch)
+{
+	batch.resize(steps);
+	for (std::size_t step = 1; step <= steps; step++) {
+		//formula taken from https://en.wikipedia.org/wiki/B%C3%A9zier_curve#Cubic_B%C3%A9zier_curves
+		const double t = step / static_cast<double>(steps);
+		const double tpow2 = t * t;
+		const double onet = (1 - t);
+		const double onetpow2 = onet * onet;
+		const la::Board_Vec waypoint = onetpow2 * (onet * start + 3 * t * control_1) + tpow2 * (3 * onet * control_2 + t * end);
+		batch.x[step - 1] = waypoint.x;
+		batch.y[step - 1] = waypoint.y;
+	}
+}
+
+void flatten::cubic_forward_differences(la::Board_Vec start, la::Board_Vec control_1, la::Board_Vec control_2, la::Board_Vec end, std::size_t steps, Point_Batch& batch)
+{
+	assert(steps > 0);
+	forward_differences(polynomial_of(start.x, control_1.x, control_2.x, end.x), polynomial_of(start.y, control_1.y, control_2.y, end.y), end, steps, batch);
+}
+
+void flatten::cubic_avx2(la::Board_Vec start, la::Board_Vec control_1, la::Board_Vec control_2, la::Board_Vec end, std::size_t steps, Point_Batch& batch)
+{
+	assert(steps > 0);
+#if defined(__AVX2__)
+	polynomial_avx2(polynomial_of(start.x, control_1.x, control_2.x, end.x), polynomial_of(start.y, control_1.y, control_2.y, end.y), end, steps, batch);
+#else
+	forward_differences(polynomial_of(start.x, control_1.x, control_2.x, end.x), polynomial_of(start.y, control_1.y, control_2.y, end.y), end, steps, batch);
+#endif
+}
+
+void flatten::cubic(la::Board_Vec start, la::Board_Vec control_1, la::Board_Vec control_2, la::Board_Vec end, std::size_t steps, Point_Batch& batch)
+{
+	assert(steps > 0);
+	polynomial_kernel(polynomial_of(start.x, control_1.x, control_2.x, end.x), polynomial_of(start.y, control_1.y, control_2.y, end.y), end, steps, batch);
+}
+
+void flatten::quadr(la::Board_Vec start, la::Board_Vec control, la::Board_Vec end, std::size_t steps, Point_Batch& batch)
+{
+	assert(steps > 0);
+	polynomial_kernel(polynomial_of(start.x, control.x, end.x), polynomial_of(start.y, control.y, end.y), end, steps, batch);
+}
+
+void flatten::ellipse_arc(const la::Transform_Matrix& transform_matrix, la::Vec2D center, double rx, double ry, 
+	double start_angle, double delta_angle, std::size_t steps, Point_Batch& batch)
+{
+	assert(steps > 0);
+	batch.resize(steps);
+
+	//point(angle) = transform_matrix * (center + (cos(angle) * rx, sin(angle) * ry)) = origin + cos(angle) * x_axis + sin(angle) * y_axis
+	const la::Board_Vec origin = transform_matrix * center;
+	const la::Board_Vec x_axis(transform_matrix.a * rx, transform_matrix.b * rx);
+	const la::Board_Vec y_axis(transform_matrix.c * ry, transform_matrix.d * ry);
+
+	const double angle_per_step = delta_angle / steps;
+	const double cos_step = std::cos(angle_per_step);
+	const double sin_step = std::sin(angle_per_step);
+	double cos_angle = std::cos(start_angle);
+	double sin_angle = std::sin(start_angle);
+
+	double* const xs = batch.x.data();
+	double* const ys = batch.y.data();
+	for (std::size_t i = 0; i + 1 < steps; i++) {
+		//angle addition theorems: cos(a + b) = cos(a)cos(b) - sin(a)sin(b), sin(a + b) = sin(a)cos(b) + cos(a)sin(b)
+		const double next_cos = cos_angle * cos_step - sin_angle * sin_step;
+		sin_angle = sin_angle * cos_step + cos_angle * sin_step;
+		cos_angle = next_cos;
+		xs[i] = origin.x + cos_angle * x_axis.x + sin_angle * y_axis.x;
+		ys[i] = origin.y + cos_angle * x_axis.y + sin_angle * y_axis.y;
+	}
+	const double end_angle = start_angle + delta_angle;	//computed exactly, as the rotations above accumulate rounding errors
+	xs[steps - 1] = origin.x + std::cos(end_angle) * x_axis.x + std::sin(end_angle) * y_axis.x;
+	ys[steps - 1] = origin.y + std::cos(end_angle) * x_axis.y + std::sin(end_angle) * y_axis.y;
+}
+
+void flatten::cable_line(la::Board_Vec start, la::Board_Vec end, double motor_distance, la::Vec2D wall_offset, double tolerance, Point_Batch& batch)
+{
+	assert(motor_distance > 0.0);
+	batch.resize(0);
+	split_cable_line(start, end, motor_distance, la::Board_Vec(wall_offset.x, wall_offset.y), tolerance, 0, batch);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "linearAlgebra.hpp"
+
+//kernels turning bezier curves, elliptical arcs and straight lines into points.
+//all kernels write the points at t = 1/steps, 2/steps, ..., steps/steps to batch (starting at index 0).
+//the start point (t = 0) is not written, as it is already drawn as end of the previous curve.
+//the last point is always exactly the end point of the curve, so following curves connect without gap.
+namespace flatten {
+
+	//points in structure of arrays layout, so the kernels can compute and store multiple coordinates at once
+	struct Point_Batch
+	{
+		std::vector<double> x;
+		std::vector<double> y;
+		std::size_t size = 0;	//x and y are never shrunk, so one batch can be reused for all curves without allocating
+
+		//sets size to new_size and makes sure x and y are big enough
+		void resize(std::size_t new_size);
+	};
+
+	//reference implementation: evaluates the bernstein polynomials for every point separately
+	void cubic_direct(la::Board_Vec start, la::Board_Vec control_1, la::Board_Vec control_2, la::Board_Vec end, std::size_t steps, Point_Batch& batch);
+
+	//forward differencing: after computing the differences once, every further point only costs three additions per coordinate
+	void cubic_forward_differences(la::Board_Vec start, la::Board_Vec control_1, la::Board_Vec control_2, la::Board_Vec end, std::size_t steps, Point_Batch& batch);
+
+	//evaluates the curve at four parameter values at once. if the program is not compiled with AVX2 enabled,
+	//this falls back to cubic_forward_differences() (see flatten::avx2_available)
+	void cubic_avx2(la::Board_Vec start, la::Board_Vec control_1, la::Board_Vec control_2, la::Board_Vec end, std::size_t steps, Point_Batch& batch);
+
+	//calls the fastest of the kernels above
+	void cubic(la::Board_Vec start, la::Board_Vec control_1, la::Board_Vec control_2, la::Board_Vec end, std::size_t steps, Point_Batch& batch);
+
+	//a quadratic bezier curve is handled by the same kernels as a cubic one, only the highest coefficient is zero
+	void quadr(la::Board_Vec start, la::Board_Vec control, la::Board_Vec end, std::size_t steps, Point_Batch& batch);
+
+	//the arc of the ellipse with center and radii rx and ry going from start_angle to start_angle + delta_angle is transformed by transform_matrix.
+	//sine and cosine are only computed for the first and the last point, the ones in between are found by repeatedly rotating by delta_angle / steps.
+	void ellipse_arc(const la::Transform_Matrix& transform_matrix, la::Vec2D center, double rx, double ry, 
+		double start_angle, double delta_angle, std::size_t steps, Point_Batch& batch);
+
+	//the plotter hangs on two cables from motors at (0, 0) and (motor_distance, 0). between two points, both cable lengths
+	//are changed linearly, which bends the line actually drawn (least near the motors, most in the middle below them).
+	//the straight line from start to end is split in halves until every piece is drawn closer than tolerance to the straight line.
+	//start and end are given on the board, which the plotter draws shifted by wall_offset (its offset_x and offset_y).
+	void cable_line(la::Board_Vec start, la::Board_Vec end, double motor_distance, la::Vec2D wall_offset, double tolerance, Point_Batch& batch);
+
+#if defined(__AVX2__)
+	constexpr bool avx2_available = true;
+#else
+	constexpr bool avx2_available = false;
+#endif
+}
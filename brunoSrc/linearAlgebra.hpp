@@ -1,8 +1,8 @@
 #pragma once
 
 #include <vector>
+#include <cmath>
 #include <iostream>
-#include <functional>
 
 namespace la {	//la standing for linear algebra
 
@@ -56,18 +56,18 @@ namespace la {	//la standing for linear algebra
 		double x;
 		double y;
 
-		explicit Board_Vec(double x_, double y_);	//do not allow brace enclosed initialisation for Board_Vec
+		constexpr explicit Board_Vec(double x_, double y_) :x(x_), y(y_) {}	//do not allow brace enclosed initialisation for Board_Vec
 	};
 
-	//these can not be constexpr, beacuse Board_Ves hac an explicit constructor :(
-	Board_Vec operator+(Board_Vec a, Board_Vec b);
-	Board_Vec operator-(Board_Vec a, Board_Vec b);
-	Board_Vec operator-(Board_Vec a);
-	Board_Vec operator*(double factor, Board_Vec vec);
-	bool operator==(Board_Vec a, Board_Vec b);
+	//defined here (and not in linearAlgebra.cpp) to allow inlining, as these are called for every point drawn
+	constexpr Board_Vec operator+(Board_Vec a, Board_Vec b) { return Board_Vec(a.x + b.x, a.y + b.y); }
+	constexpr Board_Vec operator-(Board_Vec a, Board_Vec b) { return Board_Vec(a.x - b.x, a.y - b.y); }
+	constexpr Board_Vec operator-(Board_Vec a) { return Board_Vec(-a.x, -a.y); }
+	constexpr Board_Vec operator*(double factor, Board_Vec vec) { return Board_Vec(factor * vec.x, factor * vec.y); }
+	constexpr bool operator==(Board_Vec a, Board_Vec b) { return (a.x == b.x && a.y == b.y); }
 
 	//returns 2-Norm of vec
-	double abs(Board_Vec vec);
+	inline double abs(Board_Vec vec) { return std::sqrt(vec.x * vec.x + vec.y * vec.y); }
 
 
 
@@ -102,7 +102,11 @@ namespace la {	//la standing for linear algebra
 	}
 
 	//matrix * vector, as in math. the third coordinate of vec is always 1.
-	Board_Vec operator*(const Transform_Matrix& matrix, Vec2D vec);
+	constexpr Board_Vec operator*(const Transform_Matrix& matrix, Vec2D vec)
+	{
+		return Board_Vec(matrix.a * vec.x + matrix.c * vec.y + matrix.e,
+		                 matrix.b * vec.x + matrix.d * vec.y + matrix.f);
+	}
 
 	//create matrices from different transformations
 	//these are also all taken from here: https://www.w3.org/TR/SVG11/coords.html#TransformMatrixDefined
@@ -117,9 +121,18 @@ namespace la {	//la standing for linear algebra
 	}
 	constexpr Transform_Matrix rotate(double angle, Vec2D pivot) { return translate(pivot) * rotate(angle) * translate(-pivot); }
 
+	//same as above, but takes cosine and sine of the angle, if these are already known
+	constexpr Transform_Matrix rotate(double cos_angle, double sin_angle, Vec2D pivot)
+	{
+		return translate(pivot) * in_matrix_order(cos_angle, -sin_angle, 0, sin_angle, cos_angle, 0) * translate(-pivot);
+	}
+
 	Transform_Matrix skew_x(double angle);
 	Transform_Matrix skew_y(double angle);
 
+	//returns the biggest factor the matrix stretches a vector by (the largest singular value of the 2x2 part without translation)
+	double max_stretch(const Transform_Matrix& matrix);
+
 	enum class Transform
 	{
 		matrix,
@@ -139,14 +152,3 @@ namespace la {	//la standing for linear algebra
 
 std::ostream& operator<<(std::ostream& stream, const la::Vec2D& coord);
 std::ostream& operator<<(std::ostream& stream, const la::Board_Vec& coord);
-
-//current point and next point are both inside view box -> draws straight line from current position to next point 
-//only next point is inside view box -> goes to next point (does not draw in that case)
-//otherwise does nothing
-void save_draw_to(la::Board_Vec point);
-
-//goes to point if this point resides inside view box (does not draw)
-void save_go_to(la::Board_Vec point);
-
-//allows testing to redirect the output to other places
-void set_output_functions(std::function<void (la::Board_Vec)> new_draw_to, std::function<void (la::Board_Vec)> new_go_to);
\ No newline at end of file
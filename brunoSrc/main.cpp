@@ -1,22 +1,283 @@
 #include <iostream>
 #include <sstream>
+#include <fstream>
 #include <charconv>
+#include <filesystem>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <string>
 
 #include "svgHandling.hpp"
 #include "test.hpp"
+#include "optimize.hpp"
+#include "bbfFormat.hpp"
+
+//options given in front of the other parameters (in any order)
+struct Options
+{
+	bool binary = false;	//--binary: write the binary variant of bbf
+	bool step_plan = false;	//--plan: write a step plan (see bbfFormat.hpp)
+	bool simplify = false;	//--simplify: remove points with optimize::simplify() before the other stages
+	la::Vec2D wall_offset = { 0.0, 0.0 };	//--offset <x> <y>: where the plotter puts the origin of the board (its offset_x and offset_y)
+	double max_deviation = Converter_Context::default_max_deviation;	//--deviation <mm>: see Converter_Context::set_max_deviation()
+};
+
+//reads the options at argv[1], argv[2], ... and shifts argv and argc behind them
+Options take_options(int& argc, char**& argv)
+{
+	Options options;
+	while (argc >= 2) {
+		const std::string option = argv[1];
+		if (option == "--binary") {
+			options.binary = true;
+		}
+		else if (option == "--plan") {
+			options.step_plan = true;
+		}
+		else if (option == "--simplify") {
+			options.simplify = true;
+		}
+		else if (option == "--offset" && argc >= 4) {
+			options.wall_offset = { std::strtod(argv[2], nullptr), std::strtod(argv[3], nullptr) };
+			argv += 2;
+			argc -= 2;
+		}
+		else if (option == "--deviation" && argc >= 3) {
+			options.max_deviation = std::max(0.0, std::strtod(argv[2], nullptr));
+			argv++;
+			argc--;
+		}
+		else {
+			break;
+		}
+		argv++;
+		argc--;
+	}
+	return options;
+}
+
+//what converting a single file in batch mode took
+struct Batch_Result
+{
+	std::size_t svg_bytes = 0;
+	std::size_t points = 0;
+	double milliseconds = 0.0;
+	std::string error;	//empty if the file was converted
+};
+
+//converts svg_name like real_main() does (without bitmap), the bbf is written next to the svg
+//context is only used by the calling thread, its settings apply
+Batch_Result convert_for_batch(Converter_Context& context, const std::string& svg_name, double width, double height, const Options& options)
+{
+	const auto start = std::chrono::steady_clock::now();
+	Batch_Result result;
+	try {
+		const read::Mapped_File svg(svg_name.c_str());
+		result.svg_bytes = svg.view().size();
+		Toolpath toolpath;
+		read::evaluate_svg(context, svg.view(), width, height, toolpath);
+
+		test::optimize_toolpath(toolpath, options.simplify ? optimize::step_size / 2 : 0.0, context.motor_distance, context.wall_offset, false);
+		result.points = toolpath.point_count();
+
+		const std::string bbf_name = std::filesystem::path(svg_name).replace_extension(".bbf").string();
+		if (options.step_plan) {
+			bbf::write_step_plan(toolpath, bbf_name.c_str(), context.motor_distance, context.wall_offset);
+		}
+		else if (options.binary) {
+			bbf::write_binary(toolpath, bbf_name.c_str(), width);
+		}
+		else {
+			bbf::write_text(toolpath, bbf_name.c_str());
+		}
+	}
+	catch (const std::exception& error) {
+		result.error = error.what();
+	}
+	result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
+
+//converts every svg in a directory (or every file listed in a text file, one per line) on as many threads as the machine has
+int batch_main(int argc, char* argv[])
+{
+	const Options options = take_options(argc, argv);
+	if (argc < 3 || argc > 4) {
+		std::cout << "Error: wrong numer of parameters.\n";
+		std::cout << "sooperDooperPlooter --batch [--binary] [--plan] [--simplify] [--offset <x> <y>] [--deviation <max_deviation>] <directory_or_list> <wall_width> [<wall_height>]\n";
+		return 1;
+	}
+	const double width = std::strtod(argv[2], nullptr);
+	const double height = argc == 4 ? std::strtod(argv[3], nullptr) : width;
+
+	std::vector<std::string> svg_names;
+	const std::filesystem::path source = argv[1];
+	if (std::filesystem::is_directory(source)) {
+		for (const auto& entry : std::filesystem::directory_iterator(source)) {
+			if (entry.is_regular_file() && entry.path().extension() == ".svg") {
+				svg_names.push_back(entry.path().string());
+			}
+		}
+		std::sort(svg_names.begin(), svg_names.end());
+	}
+	else {
+		std::ifstream list(source);
+		std::string line;
+		while (std::getline(list, line)) {
+			if (!line.empty()) {
+				svg_names.push_back(line);
+			}
+		}
+	}
+
+	const double motor_distance = read::motor_distance_from_config("config.txt");
+	if (motor_distance > 0.0) {
+		std::cout << "splitting lines for motors " << motor_distance << " mm apart (as found in config.txt)\n";
+	}
+	else if (options.step_plan) {
+		std::cout << "Error: a step plan needs the distance of the motors from config.txt.\n";
+		return 1;
+	}
+
+	//every thread has its own converter context and takes the next file not yet taken, until none is left
+	const std::size_t thread_count = std::max<std::size_t>(1, std::min<std::size_t>(std::thread::hardware_concurrency(), svg_names.size()));
+	std::atomic<std::size_t> next_file = 0;
+	std::mutex output_mutex;
+	std::size_t total_bytes = 0;
+	std::size_t failed = 0;
+	double total_milliseconds = 0.0;
+	auto work = [&]() {
+		Converter_Context context;
+		context.set_max_deviation(options.max_deviation);
+		context.set_motor_distance(motor_distance, options.wall_offset);
+		for (std::size_t file = next_file++; file < svg_names.size(); file = next_file++) {
+			const Batch_Result result = convert_for_batch(context, svg_names[file], width, height, options);
+			std::lock_guard<std::mutex> lock(output_mutex);
+			total_bytes += result.svg_bytes;
+			total_milliseconds += result.milliseconds;
+			if (result.error.empty()) {
+				std::cout << result.milliseconds << " ms\t" << result.points << " points\t" << svg_names[file] << "\n";
+			}
+			else {
+				failed++;
+				std::cout << "Error: " << svg_names[file] << " failed (" << result.error << ")\n";
+			}
+		}
+	};
+
+	const auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for (std::size_t i = 1; i < thread_count; i++) {
+		threads.emplace_back(work);
+	}
+	work();
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "\nconverted " << svg_names.size() - failed << " of " << svg_names.size() << " files on " << thread_count << " threads in " << seconds << " s\n";
+	std::cout << "throughput: " << svg_names.size() / seconds << " files/s, " << total_bytes / seconds / 1e6 << " MB/s of svg\n";
+	std::cout << "time summed over files: " << total_milliseconds / 1000 << " s (" << total_milliseconds / 1000 / seconds << " times the wall time)\n";
+	return failed == 0 ? 0 : 1;
+}
+
+//converts svg from stdin to sink (anything with draw_to(), go_to() and flush())
+template<typename Sink>
+void stream_svg_to(Converter_Context& context, Sink& sink, double width, double height)
+{
+	context.output.sink = &sink;
+	context.output.flush_sink = [](void* sink, const Output_Buffer& buffer) {
+		Output_Buffer::flush_to<Sink>(sink, buffer);
+		static_cast<Sink*>(sink)->flush();	//every shape reaches the pipe as soon as it is drawn
+	};
+	read::evaluate_svg_stream(context, std::cin, width, height);
+}
+
+//converts svg from stdin to bbf_output (a bbf::Text_Stream or bbf::Binary_Stream writing to stdout).
+//if the distance of the motors is known, every line is split for the cables on its way to bbf_output.
+template<typename Bbf_Stream>
+void stream_svg(Converter_Context& context, Bbf_Stream& bbf_output, double width, double height)
+{
+	if (context.motor_distance > 0.0) {
+		optimize::Cable_Splitter<Bbf_Stream> splitter(bbf_output, context.motor_distance, context.wall_offset, context.line_deviation);
+		stream_svg_to(context, splitter, width, height);
+	}
+	else {
+		stream_svg_to(context, bbf_output, width, height);
+	}
+}
+
+//reads svg from stdin and writes bbf to stdout while reading, so a document of any size can be piped through the converter
+//(and straight into the plotter, which starts drawing with the first shape).
+//every shape is written as soon as it is drawn, as it can not be optimized without the rest of the document anyway.
+//all messages go to stderr, to keep stdout for the bbf.
+int stream_main(int argc, char* argv[])
+{
+	const Options options = take_options(argc, argv);
+	if (argc < 2 || argc > 3) {
+		std::cerr << "Error: wrong numer of parameters.\n";
+		std::cerr << "sooperDooperPlooter --stream [--binary] [--offset <x> <y>] [--deviation <max_deviation>] <wall_width> [<wall_height>] < picture.svg > picture.bbf\n";
+		return 1;
+	}
+	const double width = std::strtod(argv[1], nullptr);
+	const double height = argc == 3 ? std::strtod(argv[2], nullptr) : width;
+	std::ios::sync_with_stdio(false);	//lets std::cin and std::cout buffer on their own
+
+	Converter_Context context;
+	context.set_max_deviation(options.max_deviation);
+	const double motor_distance = read::motor_distance_from_config("config.txt");
+	if (motor_distance > 0.0) {
+		std::cerr << "splitting lines for motors " << motor_distance << " mm apart (as found in config.txt)\n";
+		context.set_motor_distance(motor_distance, options.wall_offset);
+	}
+
+	try {
+		if (options.binary) {
+			bbf::Binary_Stream bbf_output(std::cout, width, height);
+			stream_svg(context, bbf_output, width, height);
+		}
+		else {
+			bbf::Text_Stream bbf_output(std::cout);
+			stream_svg(context, bbf_output, width, height);
+		}
+	}
+	catch (const std::exception& error) {
+		std::cerr << "Error: " << error.what() << "\n";
+		return 1;
+	}
+	return 0;
+}
 
 int real_main(int argc, char* argv[])
 {
-	if (argc >= 3 && argc <= 5) {
+	if (argc >= 2 && std::string(argv[1]) == "--batch") {
+		return batch_main(argc - 1, argv + 1);
+	}
+	if (argc >= 2 && std::string(argv[1]) == "--stream") {
+		return stream_main(argc - 1, argv + 1);
+	}
+	const Options options = take_options(argc, argv);
+	if (argc >= 3 && argc <= 6) {
 		const std::string svg_name = argv[1] + std::string(".svg");
 		const std::string bbf_name = argv[1] + std::string(".bbf");
 		const std::string bmp_name = argv[1] + std::string(".bmp");
 		double width = 100;
 		double height = 100;
 		uint16_t mesh_size = 100;
+		Converter_Context context;
+		context.set_max_deviation(options.max_deviation);
 		switch (argc) {
+		case 6:
+			context.set_max_deviation(std::strtod(argv[5], nullptr));
+			[[fallthrough]];
 		case 5:
 			mesh_size = std::atoi(argv[4]);
+			[[fallthrough]];
 		case 4:
 			height = std::strtod(argv[3], nullptr);
 			width = std::strtod(argv[2], nullptr);
@@ -26,11 +287,35 @@ int real_main(int argc, char* argv[])
 			width = std::strtod(argv[2], nullptr);
 			break;
 		}
+		const double motor_distance = read::motor_distance_from_config("config.txt");
+		if (motor_distance > 0.0) {
+			std::cout << "splitting lines for motors " << motor_distance << " mm apart (as found in config.txt)\n";
+			context.set_motor_distance(motor_distance, options.wall_offset);
+		}
+
 		std::cout << "\nreading in " << svg_name << " ..." << std::endl;
-		std::string content_str = read::string_from_file(svg_name.c_str());
-		read::preprocess_str(content_str);
-		test::svg_to_bmp(content_str, bmp_name.c_str(), width, height, mesh_size, 2);
-		test::svg_to_bbf(content_str, bbf_name.c_str(), width, height);
+		const read::Mapped_File svg(svg_name.c_str());
+		Toolpath toolpath;
+		read::evaluate_svg_parallel(context, svg.view(), width, height, toolpath, std::thread::hardware_concurrency());
+
+		test::optimize_toolpath(toolpath, options.simplify ? optimize::step_size / 2 : 0.0, motor_distance, options.wall_offset);
+		test::print_statistics(toolpath);
+		test::toolpath_to_bmp(toolpath, bmp_name.c_str(), width, height, mesh_size, 2);
+		if (options.step_plan) {
+			if (motor_distance <= 0.0) {
+				std::cout << "Error: a step plan needs the distance of the motors from config.txt.\n";
+				return 1;
+			}
+			std::cout << "save step plan as " << bbf_name << " ..." << std::endl;
+			bbf::write_step_plan(toolpath, bbf_name.c_str(), motor_distance, options.wall_offset);
+		}
+		else if (options.binary) {
+			std::cout << "save binary bbf as " << bbf_name << " ..." << std::endl;
+			bbf::write_binary(toolpath, bbf_name.c_str(), width);
+		}
+		else {
+			test::toolpath_to_bbf(toolpath, bbf_name.c_str());
+		}
 	}
 	else {
 		std::cout << "Error: wrong numer of parameters.\n";
@@ -38,7 +323,30 @@ int real_main(int argc, char* argv[])
 		std::cout << "sooperDooperPlooter <SVG_name> <wall_width_&_height>                   sooperDooperPlooter examplePicture 350\n";
 		std::cout << "sooperDooperPlooter <SVG_name> <wall_width> <wall_height>              sooperDooperPlooter examplePicture 350 100\n";
 		std::cout << "sooperDooperPlooter <SVG_name> <wall_width> <wall_height> <mesh_size>  sooperDooperPlooter examplePicture 350 100 10\n";
+		std::cout << "sooperDooperPlooter <SVG_name> <wall_width> <wall_height> <mesh_size> <max_deviation>\n";
+		std::cout << "                                                                       sooperDooperPlooter examplePicture 350 100 10 0.1\n";
+		std::cout << "sooperDooperPlooter --binary <any of the above>                      sooperDooperPlooter --binary examplePicture 350\n";
+		std::cout << "sooperDooperPlooter --plan <any of the above>                        sooperDooperPlooter --plan examplePicture 350\n";
+		std::cout << "sooperDooperPlooter --simplify <any of the above>                    sooperDooperPlooter --simplify examplePicture 350\n";
+		std::cout << "sooperDooperPlooter --offset <x> <y> <any of the above>              sooperDooperPlooter --offset 100 150 examplePicture 350\n";
+		std::cout << "sooperDooperPlooter --deviation <max_deviation> <any of the above>   sooperDooperPlooter --deviation 0.1 examplePicture 350\n";
+		std::cout << "sooperDooperPlooter --batch [--binary] [--plan] [--simplify] [--offset <x> <y>] [--deviation <max_deviation>] <directory_or_list> <wall_width> [<wall_height>]\n";
+		std::cout << "                                                                       sooperDooperPlooter --batch pictures 350\n";
+		std::cout << "sooperDooperPlooter --stream [--binary] [--offset <x> <y>] [--deviation <max_deviation>] <wall_width> [<wall_height>]\n";
+		std::cout << "                                                                       sooperDooperPlooter --stream 350 < big.svg > big.bbf\n";
 		std::cout << "all units are to be provided in mm.\n";
+		std::cout << "curves are split in as many lines as needed to stay closer than max_deviation (default one step, 0.025 mm) to the real curve.\n";
+		std::cout << "  a max_deviation of 0 splits every curve in a fixed amount of lines instead. --deviation sets it in every mode.\n";
+		std::cout << "if config.txt of the plotter is found next to the program, straight lines are split as needed for the distance of the motors given there.\n";
+		std::cout << "  --offset gives where the plotter draws the origin of the picture, measured from the left motor (offset_x and offset_y of the plotter).\n";
+		std::cout << "with --binary the bbf is written in the smaller binary format instead of text, which the plotter reads faster.\n";
+		std::cout << "with --simplify points are removed where the lines stay within half a step without them. this also merges the pieces\n";
+		std::cout << "  straight lines are split into, which are only split again for the cables if config.txt is found.\n";
+		std::cout << "with --plan the cable lengths are computed for the motors in config.txt, the plotter then only replays the steps.\n";
+		std::cout << "  the plotter only draws a step plan with the offset given here by --offset (0 0 without it).\n";
+		std::cout << "with --batch every svg in the directory (or listed in the file, one per line) is converted to a bbf next to it, using all cores.\n";
+		std::cout << "with --stream the svg is read from stdin in chunks and the (unoptimized) bbf is written to stdout while reading.\n";
+		std::cout << "  piped into the plotter (stepper08 -), it starts drawing with the first shape.\n";
 	}
 	return 0;
 }
@@ -54,5 +362,7 @@ int main(int argc, char* argv[])
 	//test::read_string_to_all("homer-simpson", width, height);
 	//test::read_string_to_all("bojack", width, height);
 	test::read_string_to_all("wwf", width, height);
+	//test::benchmark_flattening("wwf");
+	//test::benchmark_flattening("car");
 }
 
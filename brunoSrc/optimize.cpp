@@ -0,0 +1,804 @@
+#include "optimize.hpp"
+#include "flattening.hpp"
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <numeric>
+#include <cmath>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////functions local to this file////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+constexpr std::uint32_t no_point = std::numeric_limits<std::uint32_t>::max();
+
+inline double distance(la::Board_Vec a, la::Board_Vec b)
+{
+	return la::abs(a - b);
+}
+
+inline double distance_squared(la::Board_Vec a, la::Board_Vec b)
+{
+	const la::Board_Vec difference = a - b;
+	return difference.x * difference.x + difference.y * difference.y;
+}
+
+//2d tree over a fixed set of points, see https://en.wikipedia.org/wiki/K-d_tree
+//the tree is stored implicitly: the node of range [begin, end) in order is order[(begin + end) / 2],
+//its left subtree is [begin, middle), its right subtree is [middle + 1, end).
+//points can be removed (only the nearest() search respects that), subtrees without points left are skipped.
+class Kd_Tree
+{
+	const std::vector<la::Board_Vec>& points;
+	std::vector<std::uint32_t> order;
+	std::vector<std::uint32_t> position_of;		//position_of[point] is the position of point in order
+	std::vector<std::uint32_t> alive_in_subtree;	//alive_in_subtree[middle] counts the points not removed in the subtree of order[middle]
+	std::vector<bool> alive;
+
+	void build(std::size_t begin, std::size_t end, bool split_x)
+	{
+		if (begin >= end) {
+			return;
+		}
+		const std::size_t middle = (begin + end) / 2;
+		std::nth_element(this->order.begin() + begin, this->order.begin() + middle, this->order.begin() + end,
+			[&](std::uint32_t a, std::uint32_t b) {
+				return split_x ? this->points[a].x < this->points[b].x : this->points[a].y < this->points[b].y;
+			});
+		this->alive_in_subtree[middle] = static_cast<std::uint32_t>(end - begin);
+		this->build(begin, middle, !split_x);
+		this->build(middle + 1, end, !split_x);
+	}
+
+	void nearest(std::size_t begin, std::size_t end, bool split_x, la::Board_Vec target, std::uint32_t& best, double& best_distance) const
+	{
+		if (begin >= end) {
+			return;
+		}
+		const std::size_t middle = (begin + end) / 2;
+		if (this->alive_in_subtree[middle] == 0) {
+			return;
+		}
+		const std::uint32_t point = this->order[middle];
+		if (this->alive[point]) {
+			const double point_distance = distance_squared(target, this->points[point]);
+			if (point_distance < best_distance) {
+				best = point;
+				best_distance = point_distance;
+			}
+		}
+		const double difference = split_x ? target.x - this->points[point].x : target.y - this->points[point].y;
+		if (difference < 0) {
+			this->nearest(begin, middle, !split_x, target, best, best_distance);
+			if (difference * difference < best_distance) {
+				this->nearest(middle + 1, end, !split_x, target, best, best_distance);
+			}
+		}
+		else {
+			this->nearest(middle + 1, end, !split_x, target, best, best_distance);
+			if (difference * difference < best_distance) {
+				this->nearest(begin, middle, !split_x, target, best, best_distance);
+			}
+		}
+	}
+
+	//found is kept sorted by distance and holds at most count elements
+	void nearest(std::size_t begin, std::size_t end, bool split_x, la::Board_Vec target, std::size_t count,
+		std::vector<std::pair<double, std::uint32_t>>& found) const
+	{
+		if (begin >= end) {
+			return;
+		}
+		const std::size_t middle = (begin + end) / 2;
+		const std::uint32_t point = this->order[middle];
+		const double point_distance = distance_squared(target, this->points[point]);
+		if (found.size() < count || point_distance < found.back().first) {
+			if (found.size() == count) {
+				found.pop_back();
+			}
+			found.insert(std::upper_bound(found.begin(), found.end(), std::make_pair(point_distance, point)), std::make_pair(point_distance, point));
+		}
+		const double difference = split_x ? target.x - this->points[point].x : target.y - this->points[point].y;
+		const std::size_t near_begin = difference < 0 ? begin : middle + 1;
+		const std::size_t near_end = difference < 0 ? middle : end;
+		const std::size_t far_begin = difference < 0 ? middle + 1 : begin;
+		const std::size_t far_end = difference < 0 ? end : middle;
+		this->nearest(near_begin, near_end, !split_x, target, count, found);
+		if (found.size() < count || difference * difference < found.back().first) {
+			this->nearest(far_begin, far_end, !split_x, target, count, found);
+		}
+	}
+
+public:
+	Kd_Tree(const std::vector<la::Board_Vec>& points_)
+		:points(points_), order(points_.size()), position_of(points_.size()), alive_in_subtree(points_.size()), alive(points_.size(), true)
+	{
+		for (std::uint32_t i = 0; i < this->order.size(); i++) {
+			this->order[i] = i;
+		}
+		this->build(0, this->order.size(), true);
+		for (std::uint32_t i = 0; i < this->order.size(); i++) {
+			this->position_of[this->order[i]] = i;
+		}
+	}
+
+	void remove(std::uint32_t point)
+	{
+		if (!this->alive[point]) {
+			return;
+		}
+		this->alive[point] = false;
+		const std::size_t position = this->position_of[point];
+		std::size_t begin = 0;
+		std::size_t end = this->order.size();
+		while (true) {
+			const std::size_t middle = (begin + end) / 2;
+			this->alive_in_subtree[middle]--;
+			if (position == middle) {
+				return;
+			}
+			if (position < middle) {
+				end = middle;
+			}
+			else {
+				begin = middle + 1;
+			}
+		}
+	}
+
+	//returns the nearest point not removed, no_point if all are removed
+	std::uint32_t nearest(la::Board_Vec target) const
+	{
+		std::uint32_t best = no_point;
+		double best_distance = std::numeric_limits<double>::infinity();
+		this->nearest(0, this->order.size(), true, target, best, best_distance);
+		return best;
+	}
+
+	//writes the count nearest points (removed points included) to result, the nearest first
+	void nearest(la::Board_Vec target, std::size_t count, std::vector<std::uint32_t>& result) const
+	{
+		std::vector<std::pair<double, std::uint32_t>> found;
+		found.reserve(count + 1);
+		this->nearest(0, this->order.size(), true, target, count, found);
+		result.clear();
+		for (const auto& [point_distance, point] : found) {
+			result.push_back(point);
+		}
+	}
+};
+
+//polyline is drawn from its start to its end, if not reversed
+struct Tour_Stop
+{
+	std::uint32_t polyline;
+	bool reversed;
+};
+
+//every polyline has two endpoints: endpoint 2 * polyline is its start, endpoint 2 * polyline + 1 its end
+inline std::uint32_t entry_of(Tour_Stop stop) { return 2 * stop.polyline + (stop.reversed ? 1 : 0); }
+inline std::uint32_t exit_of(Tour_Stop stop) { return 2 * stop.polyline + (stop.reversed ? 0 : 1); }
+
+//improves the order of tour with 2-opt and Or-opt moves, see https://en.wikipedia.org/wiki/2-opt
+//to stay fast for many polylines, only moves connecting an endpoint to one of its nearest neighbours are tried.
+class Tour_Improver
+{
+	static constexpr std::size_t neighbour_count = 8;
+	static constexpr double min_gain = 1e-9;	//moves saving less are not done, as they could be undone by rounding errors
+
+	const std::vector<la::Board_Vec>& endpoints;
+	std::vector<Tour_Stop>& tour;
+	std::vector<std::uint32_t> position_of;	//position_of[polyline] is the index of its stop in tour
+	std::vector<std::uint32_t> neighbours;	//neighbours of endpoint e are neighbours[e * neighbour_count] to neighbours[(e + 1) * neighbour_count - 1]
+	std::vector<std::uint32_t> origin_neighbours;
+	const la::Board_Vec origin = la::Board_Vec(0, 0);
+
+	la::Board_Vec entry(std::size_t position) const { return this->endpoints[entry_of(this->tour[position])]; }
+	la::Board_Vec exit(std::size_t position) const { return this->endpoints[exit_of(this->tour[position])]; }
+	la::Board_Vec exit_before(std::size_t position) const { return position == 0 ? this->origin : this->exit(position - 1); }
+
+	void update_positions(std::size_t begin, std::size_t end)
+	{
+		for (std::size_t position = begin; position < end; position++) {
+			this->position_of[this->tour[position].polyline] = static_cast<std::uint32_t>(position);
+		}
+	}
+
+	const std::uint32_t* neighbours_begin(std::uint32_t endpoint) const { return this->neighbours.data() + endpoint * neighbour_count; }
+	const std::uint32_t* neighbours_end(std::uint32_t endpoint) const { return this->neighbours_begin(endpoint) + neighbour_count; }
+
+	//tries to reverse tour[i] to tour[j] for some j >= i, so that the point before i is connected to the current exit of j
+	bool try_two_opt(std::size_t i)
+	{
+		const la::Board_Vec before = this->exit_before(i);
+		const std::uint32_t* const candidates_begin = i == 0 ? this->origin_neighbours.data() : this->neighbours_begin(exit_of(this->tour[i - 1]));
+		const std::uint32_t* const candidates_end = i == 0 ? candidates_begin + this->origin_neighbours.size() : this->neighbours_end(exit_of(this->tour[i - 1]));
+
+		for (const std::uint32_t* candidate = candidates_begin; candidate != candidates_end; candidate++) {
+			const std::size_t j = this->position_of[*candidate / 2];
+			if (j < i || exit_of(this->tour[j]) != *candidate) {
+				continue;
+			}
+			double gain = distance(before, this->entry(i)) - distance(before, this->exit(j));
+			if (j + 1 < this->tour.size()) {
+				gain += distance(this->exit(j), this->entry(j + 1)) - distance(this->entry(i), this->entry(j + 1));
+			}
+			if (gain > min_gain) {
+				std::reverse(this->tour.begin() + i, this->tour.begin() + j + 1);
+				for (std::size_t position = i; position <= j; position++) {
+					this->tour[position].reversed = !this->tour[position].reversed;
+				}
+				this->update_positions(i, j + 1);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//tries to move tour[i] to tour[i + length - 1] (maybe reversed) next to a polyline ending close to them
+	bool try_or_opt(std::size_t i, std::size_t length)
+	{
+		const std::size_t segment_end = i + length;	//one past the last stop moved
+		if (segment_end > this->tour.size()) {
+			return false;
+		}
+		const la::Board_Vec before = this->exit_before(i);
+		const la::Board_Vec first_entry = this->entry(i);
+		const la::Board_Vec last_exit = this->exit(segment_end - 1);
+		double removal_gain = distance(before, first_entry);
+		if (segment_end < this->tour.size()) {
+			removal_gain += distance(last_exit, this->entry(segment_end)) - distance(before, this->entry(segment_end));
+		}
+		if (removal_gain <= min_gain) {
+			return false;
+		}
+
+		//the segment is inserted in front of tour[gap], gaps i to segment_end are where the segment already is.
+		auto insertion_cost = [&](std::size_t gap, bool reverse) {
+			const la::Board_Vec segment_in = reverse ? last_exit : first_entry;
+			const la::Board_Vec segment_out = reverse ? first_entry : last_exit;
+			const la::Board_Vec previous = this->exit_before(gap);
+			double cost = distance(previous, segment_in);
+			if (gap < this->tour.size()) {
+				cost += distance(segment_out, this->entry(gap)) - distance(previous, this->entry(gap));
+			}
+			return cost;
+		};
+
+		for (const std::uint32_t endpoint : { entry_of(this->tour[i]), exit_of(this->tour[segment_end - 1]) }) {
+			for (const std::uint32_t* candidate = this->neighbours_begin(endpoint); candidate != this->neighbours_end(endpoint); candidate++) {
+				const std::size_t position = this->position_of[*candidate / 2];
+				for (const std::size_t gap : { position, position + 1 }) {
+					if (gap >= i && gap <= segment_end) {
+						continue;
+					}
+					for (const bool reverse : { false, true }) {
+						if (removal_gain - insertion_cost(gap, reverse) > min_gain) {
+							this->move_segment(i, segment_end, gap, reverse);
+							return true;
+						}
+					}
+				}
+			}
+		}
+		return false;
+	}
+
+	void move_segment(std::size_t begin, std::size_t end, std::size_t gap, bool reverse)
+	{
+		if (reverse) {
+			std::reverse(this->tour.begin() + begin, this->tour.begin() + end);
+			for (std::size_t position = begin; position < end; position++) {
+				this->tour[position].reversed = !this->tour[position].reversed;
+			}
+		}
+		if (gap < begin) {
+			std::rotate(this->tour.begin() + gap, this->tour.begin() + begin, this->tour.begin() + end);
+			this->update_positions(gap, end);
+		}
+		else {
+			std::rotate(this->tour.begin() + begin, this->tour.begin() + end, this->tour.begin() + gap);
+			this->update_positions(begin, gap);
+		}
+	}
+
+public:
+	Tour_Improver(const std::vector<la::Board_Vec>& endpoints_, std::vector<Tour_Stop>& tour_, const Kd_Tree& tree)
+		:endpoints(endpoints_), tour(tour_), position_of(tour_.size()), neighbours(endpoints_.size() * neighbour_count)
+	{
+		this->update_positions(0, this->tour.size());
+
+		std::vector<std::uint32_t> found;
+		for (std::uint32_t endpoint = 0; endpoint < this->endpoints.size(); endpoint++) {
+			//the endpoint itself and the other end of its polyline are found as well, but they are never a valid candidate
+			tree.nearest(this->endpoints[endpoint], neighbour_count, found);
+			found.resize(neighbour_count, endpoint);
+			std::copy(found.begin(), found.end(), this->neighbours.begin() + endpoint * neighbour_count);
+		}
+		tree.nearest(this->origin, neighbour_count, this->origin_neighbours);
+	}
+
+	//returns once no move improves the tour or deadline is reached
+	void improve(std::chrono::steady_clock::time_point deadline)
+	{
+		bool improved = true;
+		while (improved) {
+			improved = false;
+			for (std::size_t i = 0; i < this->tour.size(); i++) {
+				if (i % 256 == 0 && std::chrono::steady_clock::now() > deadline) {
+					return;
+				}
+				improved |= this->try_two_opt(i);
+				for (std::size_t length = 1; length <= 3; length++) {
+					improved |= this->try_or_opt(i, length);
+				}
+			}
+		}
+	}
+};
+
+//distance of point to the line segment from start to end
+double distance_to_segment(la::Board_Vec point, la::Board_Vec start, la::Board_Vec end)
+{
+	const la::Board_Vec direction = end - start;
+	const double length_squared = direction.x * direction.x + direction.y * direction.y;
+	if (length_squared == 0.0) {
+		return distance(point, start);
+	}
+	const la::Board_Vec offset = point - start;
+	const double t = std::clamp((offset.x * direction.x + offset.y * direction.y) / length_squared, 0.0, 1.0);
+	return distance(point, start + t * direction);
+}
+
+//straight line drawn from start to end
+struct Segment
+{
+	la::Board_Vec start;
+	la::Board_Vec end;
+};
+
+//stores segments in all square cells their bounding box touches, see https://en.wikipedia.org/wiki/Grid_(spatial_index)
+class Segment_Grid
+{
+	static constexpr double cell_size = 2.0;	//in mm
+	std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> cells;
+	std::vector<Segment> segments;
+
+	static std::int64_t cell_of(double coordinate) { return static_cast<std::int64_t>(std::floor(coordinate / cell_size)); }
+
+	static std::uint64_t key_of(std::int64_t cell_x, std::int64_t cell_y)
+	{
+		return (static_cast<std::uint64_t>(cell_x) << 32) ^ static_cast<std::uint64_t>(cell_y & 0xFFFFFFFF);
+	}
+
+	//calls function with key of every cell touched by segment grown by margin (in both directions).
+	//the cells are walked column by column: in every column only the cells between the lowest and the highest y the segment
+	//reaches there (plus margin) are visited, so a long diagonal touches about as many cells as it crosses, not its whole bounding box.
+	template<typename Function>
+	static void for_cells_of(const Segment& segment, double margin, Function function)
+	{
+		const la::Board_Vec left = segment.start.x <= segment.end.x ? segment.start : segment.end;
+		const la::Board_Vec right = segment.start.x <= segment.end.x ? segment.end : segment.start;
+		const double width = right.x - left.x;
+		auto y_at = [&](double x) { return width > 0.0 ? left.y + (right.y - left.y) * ((x - left.x) / width) : left.y; };
+
+		const std::int64_t min_x = cell_of(left.x - margin);
+		const std::int64_t max_x = cell_of(right.x + margin);
+		for (std::int64_t x = min_x; x <= max_x; x++) {
+			//part of segment lying in the column (grown by margin)
+			const double from_y = width > 0.0 ? y_at(std::max(left.x, x * cell_size - margin)) : left.y;
+			const double to_y = width > 0.0 ? y_at(std::min(right.x, (x + 1) * cell_size + margin)) : right.y;
+			const std::int64_t min_y = cell_of(std::min(from_y, to_y) - margin);
+			const std::int64_t max_y = cell_of(std::max(from_y, to_y) + margin);
+			for (std::int64_t y = min_y; y <= max_y; y++) {
+				function(key_of(x, y));
+			}
+		}
+	}
+
+public:
+	void add(const Segment& segment)
+	{
+		const std::uint32_t index = static_cast<std::uint32_t>(this->segments.size());
+		this->segments.push_back(segment);
+		for_cells_of(segment, 0.0, [&](std::uint64_t key) { this->cells[key].push_back(index); });
+	}
+
+	//calls function with every segment stored in a cell touched by segment (grown by margin). segments may be found more than once.
+	template<typename Function>
+	void for_segments_near(const Segment& segment, double margin, Function function) const
+	{
+		for_cells_of(segment, margin, [&](std::uint64_t key) {
+			const auto cell = this->cells.find(key);
+			if (cell != this->cells.end()) {
+				for (const std::uint32_t index : cell->second) {
+					function(this->segments[index]);
+				}
+			}
+		});
+	}
+};
+
+//if segment and kept are collinear (closer than tolerance), the part of segment lying next to kept is returned
+//as interval of the parameter t in segment.start + t * (segment.end - segment.start). else an empty interval is returned.
+std::pair<double, double> overlap_of(const Segment& segment, const Segment& kept, double tolerance)
+{
+	const std::pair<double, double> no_overlap = { 1.0, 0.0 };
+	const la::Board_Vec kept_direction = kept.end - kept.start;
+	const double kept_length = la::abs(kept_direction);
+	if (kept_length <= tolerance) {
+		return no_overlap;
+	}
+	const la::Board_Vec unit = (1 / kept_length) * kept_direction;
+	const la::Board_Vec start_offset = segment.start - kept.start;
+	const la::Board_Vec end_offset = segment.end - kept.start;
+	//distance to line through kept is the absolute value of the 2d cross product with unit
+	if (std::abs(unit.x * start_offset.y - unit.y * start_offset.x) > tolerance || 
+	    std::abs(unit.x * end_offset.y - unit.y * end_offset.x) > tolerance) {
+		return no_overlap;
+	}
+	//position along kept of segment.start and segment.end
+	const double start_along = unit.x * start_offset.x + unit.y * start_offset.y;
+	const double end_along = unit.x * end_offset.x + unit.y * end_offset.y;
+	if (start_along == end_along) {
+		return start_along >= 0.0 && start_along <= kept_length ? std::make_pair(0.0, 1.0) : no_overlap;
+	}
+	const double t_at_kept_start = (0.0 - start_along) / (end_along - start_along);
+	const double t_at_kept_end = (kept_length - start_along) / (end_along - start_along);
+	return { std::max(0.0, std::min(t_at_kept_start, t_at_kept_end)), std::min(1.0, std::max(t_at_kept_start, t_at_kept_end)) };
+}
+
+//finds points closer than tolerance to each other by sorting them into square cells of side length tolerance.
+//as every point is only stored, if no point closer than tolerance is stored already, the points stored are called vertices.
+class Spatial_Hash
+{
+	double cell_size;
+	std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> cells;	//vertices in each cell
+	std::vector<la::Board_Vec> vertices;
+	double tolerance;
+
+	std::int64_t cell_of(double coordinate) const { return static_cast<std::int64_t>(std::floor(coordinate / this->cell_size)); }
+
+	static std::uint64_t key_of(std::int64_t cell_x, std::int64_t cell_y)
+	{
+		return (static_cast<std::uint64_t>(cell_x) << 32) ^ static_cast<std::uint64_t>(cell_y & 0xFFFFFFFF);
+	}
+
+public:
+	Spatial_Hash(double tolerance_) :cell_size(tolerance_ > 0.0 ? tolerance_ : 1.0), tolerance(tolerance_) {}
+
+	//returns the vertex closer than tolerance to point, if there is none, point is added as new vertex
+	std::uint32_t vertex_of(la::Board_Vec point)
+	{
+		const std::int64_t cell_x = this->cell_of(point.x);
+		const std::int64_t cell_y = this->cell_of(point.y);
+		for (std::int64_t x = cell_x - 1; x <= cell_x + 1; x++) {
+			for (std::int64_t y = cell_y - 1; y <= cell_y + 1; y++) {
+				const auto cell = this->cells.find(key_of(x, y));
+				if (cell == this->cells.end()) {
+					continue;
+				}
+				for (const std::uint32_t vertex : cell->second) {
+					if (distance(this->vertices[vertex], point) <= this->tolerance) {
+						return vertex;
+					}
+				}
+			}
+		}
+		const std::uint32_t new_vertex = static_cast<std::uint32_t>(this->vertices.size());
+		this->vertices.push_back(point);
+		this->cells[key_of(cell_x, cell_y)].push_back(new_vertex);
+		return new_vertex;
+	}
+
+	std::size_t vertex_count() const { return this->vertices.size(); }
+};
+
+//returns representative of the set element belongs to, see https://en.wikipedia.org/wiki/Disjoint-set_data_structure
+std::uint32_t find_set(std::vector<std::uint32_t>& parents, std::uint32_t element)
+{
+	while (parents[element] != element) {
+		parents[element] = parents[parents[element]];
+		element = parents[element];
+	}
+	return element;
+}
+
+//edge of the graph build by join_polylines(), traversed from vertex from to vertex to.
+struct Trail_Step
+{
+	std::uint32_t edge;
+	bool forward;	//true if edge is traversed from its first to its second vertex
+};
+
+//finds an eulerian circuit with Hierholzer's algorithm, see https://en.wikipedia.org/wiki/Eulerian_path#Hierholzer's_algorithm
+//every vertex reachable from start is expected to have even degree. used edges are marked in used_edges.
+std::vector<Trail_Step> eulerian_circuit(std::uint32_t start, const std::vector<std::array<std::uint32_t, 2>>& edges, 
+	const std::vector<std::vector<std::uint32_t>>& edges_at, std::vector<std::size_t>& next_edge_at, std::vector<bool>& used_edges)
+{
+	struct Stack_Elem
+	{
+		std::uint32_t vertex;
+		Trail_Step arrived_by;
+	};
+	std::vector<Stack_Elem> stack = { { start, { 0, true } } };
+	std::vector<Trail_Step> circuit;
+
+	while (!stack.empty()) {
+		const std::uint32_t vertex = stack.back().vertex;
+		std::size_t& next = next_edge_at[vertex];
+		while (next < edges_at[vertex].size() && used_edges[edges_at[vertex][next]]) {
+			next++;
+		}
+		if (next < edges_at[vertex].size()) {
+			const std::uint32_t edge = edges_at[vertex][next];
+			used_edges[edge] = true;
+			const bool forward = edges[edge][0] == vertex;
+			stack.push_back({ forward ? edges[edge][1] : edges[edge][0], { edge, forward } });
+		}
+		else {
+			if (stack.size() > 1) {
+				circuit.push_back(stack.back().arrived_by);
+			}
+			stack.pop_back();
+		}
+	}
+	std::reverse(circuit.begin(), circuit.end());
+	return circuit;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////functions visible from the outside//////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Toolpath optimize::minimize_travel(const Toolpath& toolpath, double time_budget_seconds)
+{
+	const auto deadline = std::chrono::steady_clock::now() +
+		std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(time_budget_seconds));
+
+	std::vector<std::size_t> drawn_polylines;	//the polylines of toolpath which draw anything
+	std::vector<la::Board_Vec> endpoints;
+	for (std::size_t polyline = 0; polyline < toolpath.polyline_count(); polyline++) {
+		if (toolpath.end_of(polyline) - toolpath.begin_of(polyline) > 1) {
+			drawn_polylines.push_back(polyline);
+			endpoints.push_back(toolpath.point(toolpath.begin_of(polyline)));
+			endpoints.push_back(toolpath.point(toolpath.end_of(polyline) - 1));
+		}
+	}
+	if (drawn_polylines.empty()) {
+		return Toolpath();
+	}
+
+	//first tour: always go to the nearest polyline not drawn yet
+	Kd_Tree tree(endpoints);
+	std::vector<Tour_Stop> tour;
+	tour.reserve(drawn_polylines.size());
+	la::Board_Vec current(0, 0);
+	for (std::size_t i = 0; i < drawn_polylines.size(); i++) {
+		const std::uint32_t endpoint = tree.nearest(current);
+		const Tour_Stop stop = { endpoint / 2, endpoint % 2 == 1 };
+		tree.remove(entry_of(stop));
+		tree.remove(exit_of(stop));
+		tour.push_back(stop);
+		current = endpoints[exit_of(stop)];
+	}
+
+	Tour_Improver(endpoints, tour, tree).improve(deadline);
+
+	Toolpath result;
+	for (const Tour_Stop stop : tour) {
+		const std::size_t polyline = drawn_polylines[stop.polyline];
+		const std::size_t begin = toolpath.begin_of(polyline);
+		const std::size_t end = toolpath.end_of(polyline);
+		if (stop.reversed) {
+			result.go_to(toolpath.point(end - 1));
+			for (std::size_t i = end - 1; i-- > begin;) {
+				result.draw_to(toolpath.point(i));
+			}
+		}
+		else {
+			result.go_to(toolpath.point(begin));
+			for (std::size_t i = begin + 1; i < end; i++) {
+				result.draw_to(toolpath.point(i));
+			}
+		}
+	}
+	return result;
+}
+
+Toolpath optimize::join_polylines(const Toolpath& toolpath, double tolerance)
+{
+	//every polyline drawing anything becomes an edge between the vertices at its ends
+	std::vector<std::size_t> drawn_polylines;
+	std::vector<std::array<std::uint32_t, 2>> edges;
+	Spatial_Hash vertices(tolerance);
+	for (std::size_t polyline = 0; polyline < toolpath.polyline_count(); polyline++) {
+		if (toolpath.end_of(polyline) - toolpath.begin_of(polyline) > 1) {
+			drawn_polylines.push_back(polyline);
+			edges.push_back({ vertices.vertex_of(toolpath.point(toolpath.begin_of(polyline))), 
+			                  vertices.vertex_of(toolpath.point(toolpath.end_of(polyline) - 1)) });
+		}
+	}
+	const std::size_t real_edge_count = edges.size();
+
+	//vertices of odd degree are paired up (within their connected part) by virtual edges. 
+	//this makes every degree even, the virtual edges later split the eulerian circuits into trails.
+	std::vector<std::uint32_t> degrees(vertices.vertex_count(), 0);
+	std::vector<std::uint32_t> parts(vertices.vertex_count());
+	std::iota(parts.begin(), parts.end(), 0);
+	for (const auto& [from, to] : edges) {
+		degrees[from]++;
+		degrees[to]++;
+		parts[find_set(parts, from)] = find_set(parts, to);
+	}
+	std::vector<std::uint32_t> unpaired_odd_vertex(vertices.vertex_count(), no_point);	//indexed by representative of connected part
+	for (std::uint32_t vertex = 0; vertex < vertices.vertex_count(); vertex++) {
+		if (degrees[vertex] % 2 == 1) {
+			std::uint32_t& partner = unpaired_odd_vertex[find_set(parts, vertex)];
+			if (partner == no_point) {
+				partner = vertex;
+			}
+			else {
+				edges.push_back({ partner, vertex });
+				partner = no_point;
+			}
+		}
+	}
+
+	std::vector<std::vector<std::uint32_t>> edges_at(vertices.vertex_count());
+	for (std::uint32_t edge = 0; edge < edges.size(); edge++) {
+		edges_at[edges[edge][0]].push_back(edge);
+		edges_at[edges[edge][1]].push_back(edge);
+	}
+
+	Toolpath result;
+	auto draw_edge = [&](Trail_Step step, bool starts_trail) {
+		const std::size_t polyline = drawn_polylines[step.edge];
+		const std::size_t begin = toolpath.begin_of(polyline);
+		const std::size_t end = toolpath.end_of(polyline);
+		//the first point of an edge is (closer than tolerance to) the last point of the edge before, thus it is only drawn at the start of a trail
+		if (step.forward) {
+			if (starts_trail) {
+				result.go_to(toolpath.point(begin));
+			}
+			for (std::size_t i = begin + 1; i < end; i++) {
+				result.draw_to(toolpath.point(i));
+			}
+		}
+		else {
+			if (starts_trail) {
+				result.go_to(toolpath.point(end - 1));
+			}
+			for (std::size_t i = end - 1; i-- > begin;) {
+				result.draw_to(toolpath.point(i));
+			}
+		}
+	};
+
+	std::vector<std::size_t> next_edge_at(vertices.vertex_count(), 0);
+	std::vector<bool> used_edges(edges.size(), false);
+	for (std::uint32_t edge = 0; edge < real_edge_count; edge++) {	//every connected part is drawn, when its first edge is reached
+		if (used_edges[edge]) {
+			continue;
+		}
+		std::vector<Trail_Step> circuit = eulerian_circuit(edges[edge][0], edges, edges_at, next_edge_at, used_edges);
+
+		//the circuit is rotated to start after a virtual edge, so every virtual edge ends a trail
+		const auto virtual_step = std::find_if(circuit.begin(), circuit.end(), [&](Trail_Step step) { return step.edge >= real_edge_count; });
+		if (virtual_step != circuit.end()) {
+			std::rotate(circuit.begin(), virtual_step + 1, circuit.end());
+		}
+		bool starts_trail = true;
+		for (const Trail_Step step : circuit) {
+			if (step.edge >= real_edge_count) {
+				starts_trail = true;
+				continue;
+			}
+			draw_edge(step, starts_trail);
+			starts_trail = false;
+		}
+	}
+	return result;
+}
+
+Toolpath optimize::remove_overlaps(const Toolpath& toolpath, double tolerance)
+{
+	Segment_Grid kept_segments;
+	Toolpath result;
+	bool drawing = false;	//true if the last point added to result was drawn to and no part was dropped since
+	std::vector<std::pair<double, double>> overlaps;
+
+	for (std::size_t polyline = 0; polyline < toolpath.polyline_count(); polyline++) {
+		drawing = false;
+		for (std::size_t i = toolpath.begin_of(polyline) + 1; i < toolpath.end_of(polyline); i++) {
+			const Segment segment = { toolpath.point(i - 1), toolpath.point(i) };
+			const double length = distance(segment.start, segment.end);
+
+			overlaps.clear();
+			kept_segments.for_segments_near(segment, tolerance, [&](const Segment& kept) {
+				const std::pair<double, double> overlap = overlap_of(segment, kept, tolerance);
+				if ((overlap.second - overlap.first) * length > tolerance) {	//touching ends are no overlap
+					overlaps.push_back(overlap);
+				}
+			});
+			std::sort(overlaps.begin(), overlaps.end());
+			overlaps.emplace_back(1.0, 1.0);	//marks end of segment
+
+			//the parts of segment not overlapped by others are kept
+			double part_start = 0.0;
+			for (const auto& [overlap_start, overlap_end] : overlaps) {
+				if (overlap_start > part_start && ((overlap_start - part_start) * length > tolerance || overlaps.size() == 1)) {
+					const Segment part = { segment.start + part_start * (segment.end - segment.start), 
+					                       segment.start + overlap_start * (segment.end - segment.start) };
+					if (!drawing || part_start > 0.0) {
+						result.go_to(part.start);
+					}
+					result.draw_to(part.end);
+					kept_segments.add(part);
+					drawing = overlap_start == 1.0;
+				}
+				else if (overlap_end > part_start) {
+					drawing = false;
+				}
+				part_start = std::max(part_start, overlap_end);
+			}
+		}
+	}
+	return result;
+}
+
+Toolpath optimize::simplify(const Toolpath& toolpath, double tolerance)
+{
+	Toolpath result;
+	std::vector<bool> keep;
+	std::vector<std::pair<std::size_t, std::size_t>> ranges;	//ranges still to simplify, both ends are kept
+
+	for (std::size_t polyline = 0; polyline < toolpath.polyline_count(); polyline++) {
+		const std::size_t begin = toolpath.begin_of(polyline);
+		const std::size_t end = toolpath.end_of(polyline);
+		keep.assign(end - begin, false);
+		keep.front() = true;
+		keep.back() = true;
+
+		ranges.emplace_back(begin, end - 1);
+		while (!ranges.empty()) {
+			const auto [first, last] = ranges.back();
+			ranges.pop_back();
+			double max_distance = 0.0;
+			std::size_t farthest = first;
+			for (std::size_t i = first + 1; i < last; i++) {
+				const double point_distance = distance_to_segment(toolpath.point(i), toolpath.point(first), toolpath.point(last));
+				if (point_distance > max_distance) {
+					max_distance = point_distance;
+					farthest = i;
+				}
+			}
+			if (max_distance > tolerance) {
+				keep[farthest - begin] = true;
+				ranges.emplace_back(first, farthest);
+				ranges.emplace_back(farthest, last);
+			}
+		}
+
+		result.go_to(toolpath.point(begin));
+		for (std::size_t i = begin + 1; i < end; i++) {
+			if (keep[i - begin]) {
+				result.draw_to(toolpath.point(i));
+			}
+		}
+	}
+	return result;
+}
+
+Toolpath optimize::split_for_cables(const Toolpath& toolpath, double motor_distance, la::Vec2D wall_offset, double tolerance)
+{
+	Toolpath result;
+	Cable_Splitter<Toolpath> splitter(result, motor_distance, wall_offset, tolerance);
+	toolpath.replay(splitter);
+	return result;
+}
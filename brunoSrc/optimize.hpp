@@ -0,0 +1,80 @@
+#pragma once
+
+#include "toolpath.hpp"
+#include "flattening.hpp"
+
+//stages run on a converted toolpath before it is written out, to make the plotter faster.
+//none of them changes what is drawn (at least not by more than the tolerance given).
+namespace optimize {
+
+	//distance the plotter moves per motor step, as steps_per_mm is 40 in basheySrc/stepper08.cpp
+	constexpr double step_size = 1.0 / 40.0;
+
+	//removes points of every polyline with the Ramer-Douglas-Peucker algorithm, see https://en.wikipedia.org/wiki/Ramer%E2%80%93Douglas%E2%80%93Peucker_algorithm
+	//the simplified polyline is nowhere further than tolerance away from the original one.
+	//with the default tolerance, the motors would move the same steps for the simplified polyline as for the original.
+	Toolpath simplify(const Toolpath& toolpath, double tolerance = step_size / 2);
+
+	//removes the parts of lines already drawn before (closer than tolerance), as shapes sharing a border would draw it twice.
+	//every line drawn is compared to the lines kept before it, which are found in a uniform grid.
+	//if both ends of the line are closer than tolerance to the (infinite) extension of a kept line, they are collinear
+	//and the part of the line lying next to the kept line is dropped. the pen is lifted to skip dropped parts.
+	Toolpath remove_overlaps(const Toolpath& toolpath, double tolerance = step_size / 2);
+
+	//polylines with ends closer than tolerance to each other are joined to longer polylines, to lift the pen less often.
+	//the polylines are seen as edges of a graph, where ends closer than tolerance are the same vertex (found with a spatial hash).
+	//every connected part of the graph is drawn in as few polylines as possible by following eulerian trails:
+	//a part with 2 * n vertices of odd degree needs n polylines (1 if n is 0), see https://en.wikipedia.org/wiki/Eulerian_path
+	//polylines consisting of a single point draw nothing and are dropped.
+	Toolpath join_polylines(const Toolpath& toolpath, double tolerance = step_size / 2);
+
+	//splits every line drawn, so the plotter (changing its cable lengths linearly between two points) stays closer
+	//than tolerance to the line, see flatten::cable_line(). this is meant to be the last stage, as simplify() would undo it.
+	//wall_offset is where the plotter puts the origin of the board (its offset_x and offset_y).
+	Toolpath split_for_cables(const Toolpath& toolpath, double motor_distance, la::Vec2D wall_offset, double tolerance = step_size);
+
+	//sink splitting every line drawn to it as split_for_cables() does, before handing the pieces on to sink.
+	//split_for_cables() uses it on the finished toolpath, the stream mode (which can not optimize) on every point converted.
+	template<typename Sink>
+	class Cable_Splitter
+	{
+		Sink& sink;
+		double motor_distance;
+		la::Vec2D wall_offset;
+		double tolerance;
+		la::Board_Vec prev_point = la::Board_Vec(0, 0);
+		flatten::Point_Batch pieces;
+
+	public:
+		Cable_Splitter(Sink& sink, double motor_distance, la::Vec2D wall_offset, double tolerance = step_size)
+			:sink(sink), motor_distance(motor_distance), wall_offset(wall_offset), tolerance(tolerance)
+		{}
+
+		void go_to(la::Board_Vec point);
+		void draw_to(la::Board_Vec point);
+		void flush() { this->sink.flush(); }	//only for sinks with flush()
+	};
+
+	//reorders the polylines of toolpath (and reverses the direction of some) to shorten the distance moved with the pen up.
+	//the plotter is assumed to start at (0, 0). a first order is found by always going to the nearest polyline not yet drawn
+	//(searched in a k-d tree), which is then improved by 2-opt and Or-opt moves until no move helps or time_budget_seconds has passed.
+	//polylines consisting of a single point draw nothing and are dropped.
+	Toolpath minimize_travel(const Toolpath& toolpath, double time_budget_seconds = 1.0);
+}
+
+template<typename Sink>
+void optimize::Cable_Splitter<Sink>::go_to(la::Board_Vec point)
+{
+	this->sink.go_to(point);
+	this->prev_point = point;
+}
+
+template<typename Sink>
+void optimize::Cable_Splitter<Sink>::draw_to(la::Board_Vec point)
+{
+	flatten::cable_line(this->prev_point, point, this->motor_distance, this->wall_offset, this->tolerance, this->pieces);
+	for (std::size_t piece = 0; piece < this->pieces.size; piece++) {
+		this->sink.draw_to(la::Board_Vec(this->pieces.x[piece], this->pieces.y[piece]));
+	}
+	this->prev_point = point;
+}
@@ -1,5 +1,6 @@
 
 #include "svgHandling.hpp"
+#include "flattening.hpp"
 
 
 #include <cmath>
@@ -11,6 +12,29 @@
 #include <algorithm>
 #include <charconv>
 #include <cstring>
+#include <cctype>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <istream>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cstdio>	//not <unistd.h>, as its read() would clash with namespace read
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////functions local to this file////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -28,24 +52,101 @@ constexpr double to_rad(double degree)
 	return degree * la::pi / 180.0;
 }
 
-//made to find matching "</svg>" and "</g>" to the opening ones
-//function assumes, that search_zone already misses the opening sequence for searched closing_sequence.
-//-> if "</g>" is searched, there is one "</g>" more in search_zone, than there are "<g ..." in search_zone
-std::size_t find_closing_elem(std::string_view search_zone, std::string_view opening_sequence, std::string_view closing_sequence)
+//whitespace as it may be found in between the parts of an element
+constexpr bool is_space(char c)
 {
-	assert(opening_sequence != closing_sequence);
+	return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+//returns position of first character at or after start, that is not whitespace (view.length() if there is none)
+std::size_t skip_spaces(std::string_view view, std::size_t start = 0)
+{
+	while (start < view.length() && is_space(view[start])) {
+		start++;
+	}
+	return start;
+}
 
-	std::size_t next_open = -1;
-	std::size_t next_clsd = 0;
+//returns position of the '>' ending the tag starting at view[0]. '>' in between quotes are skipped.
+std::size_t find_tag_end(std::string_view view, std::size_t start)
+{
+	std::size_t next = view.find_first_of("\"'>", start);
+	while (next != std::string::npos && view[next] != '>') {
+		const std::size_t closing_quote = view.find(view[next], next + 1);
+		if (closing_quote == std::string::npos) {
+			throw std::runtime_error("function find_tag_end(): quotation (using \"\" or '') was started, but not ended.");
+		}
+		next = view.find_first_of("\"'>", closing_quote + 1);
+	}
+	if (next == std::string::npos) {
+		throw std::runtime_error("function find_tag_end(): tag was started with '<', but not ended with '>'.");
+	}
+	return next;
+}
 
-	do {
-		do {
-			next_open = read::find_skip_quotations(search_zone, opening_sequence, next_open + 1);
-		} while (next_open != std::string::npos && (search_zone[next_open + opening_sequence.length()] != ' ' && search_zone[next_open + opening_sequence.length()] != '>'));
+//returns number of zero bits in front of the lowest set bit. mask is expected to not be 0.
+inline unsigned int count_trailing_zeros(unsigned int mask)
+{
+	assert(mask != 0);
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+//seperators in between numbers of a number list
+constexpr bool is_number_seperator(char c)
+{
+	return is_space(c) || c == ',';
+}
+
+//returns first position in [begin, end) not holding a seperator (end if there is none).
+//number lists mostly hold a single seperator in between two numbers, so the first characters are checked one by one.
+//longer runs (indentation and line breaks in path data) are skipped 32 or 16 characters at a time.
+const char* skip_number_seperators(const char* begin, const char* end)
+{
+	for (int i = 0; i < 2 && begin < end; i++, begin++) {
+		if (!is_number_seperator(*begin)) {
+			return begin;
+		}
+	}
+
+#if defined(__AVX2__)
+	while (end - begin >= 32) {
+		const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+		const __m256i seperators = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(','))),
+			_mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\t'))),
+			                _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\r'))));
+		const unsigned int no_seperator = ~static_cast<unsigned int>(_mm256_movemask_epi8(seperators));
+		if (no_seperator != 0) {
+			return begin + count_trailing_zeros(no_seperator);
+		}
+		begin += 32;
+	}
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+	while (end - begin >= 16) {
+		const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+		const __m128i seperators = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chars, _mm_set1_epi8(','))),
+			_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(chars, _mm_set1_epi8('\t'))),
+			             _mm_cmpeq_epi8(chars, _mm_set1_epi8('\r'))));
+		const unsigned int no_seperator = ~static_cast<unsigned int>(_mm_movemask_epi8(seperators)) & 0xFFFFu;
+		if (no_seperator != 0) {
+			return begin + count_trailing_zeros(no_seperator);
+		}
+		begin += 16;
+	}
+#endif
 
-		next_clsd = read::find_skip_quotations(search_zone, closing_sequence, next_clsd + closing_sequence.length());
-	} while (next_open < next_clsd);
-	return next_clsd;
+	while (begin < end && is_number_seperator(*begin)) {
+		begin++;
+	}
+	return begin;
 }
 
 //helper for to_scaled()
@@ -79,11 +180,6 @@ std::string_view in_between(std::string_view original, std::size_t fst, std::siz
 ///////////////////////////////////////////////////////////functions visible from the outside//////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-//default values (get replaced by set() anyway)
-la::Board_Vec View_Box::min = la::Board_Vec(0, 0);
-la::Board_Vec View_Box::max = la::Board_Vec(100, 100);
-
-
 la::Transform_Matrix View_Box::private_set(double min_x, double min_y, double width, double height, double board_width, double board_height)
 {
 	if (width / height < board_width / board_height) {	//view box has taller aspect ratio than board -> leaving space on right and left side of board
@@ -91,10 +187,10 @@ la::Transform_Matrix View_Box::private_set(double min_x, double min_y, double wi
 		const double view_width_in_board_units = width * scaling_factor;	//width of view box given in board coordinates
 		const double x_offset = (board_width - view_width_in_board_units) / 2;	//x-coordinate of left boundary of view box given in board coordinates
 
-		View_Box::min.x = x_offset;
-		View_Box::max.x = x_offset + view_width_in_board_units;
-		View_Box::min.y = 0;
-		View_Box::max.y = board_height;
+		this->min.x = x_offset;
+		this->max.x = x_offset + view_width_in_board_units;
+		this->min.y = 0;
+		this->max.y = board_height;
 
 		//     shift to middle of board         scaling to board units                      translate in svg units to (0, 0)
 		return la::translate({ x_offset, 0 }) * la::scale(scaling_factor, scaling_factor) * la::translate({ -min_x, -min_y });
@@ -103,10 +199,10 @@ la::Transform_Matrix View_Box::private_set(double min_x, double min_y, double wi
 		const double scaling_factor = board_width / width;
 		const double view_height_in_board_units = height * scaling_factor;
 
-		View_Box::min.x = 0;
-		View_Box::max.x = board_width;
-		View_Box::min.y = 0;
-		View_Box::max.y = view_height_in_board_units;
+		this->min.x = 0;
+		this->max.x = board_width;
+		this->min.y = 0;
+		this->max.y = view_height_in_board_units;
 
 		//     scaling to board units                  translate in svg units to (0, 0)
 		return la::scale(scaling_factor, scaling_factor) * la::translate({ -min_x, -min_y });
@@ -115,26 +211,144 @@ la::Transform_Matrix View_Box::private_set(double min_x, double min_y, double wi
 
 la::Transform_Matrix View_Box::set(std::string_view data, double board_width, double board_height)
 {
-	const std::vector<double> values = read::from_csv(data);
-	assert(values.size() == 4);
+	double values[4] = {};
+	const std::size_t values_read = read::Number_Scanner(data).next(values, 4);
+	assert(values_read == 4);
 
 	const double min_x = values[0];
 	const double min_y = values[1];
 	const double width = values[2];
 	const double height = values[3];
 
-	return private_set(min_x, min_y, width, height, board_width, board_height);
+	return this->private_set(min_x, min_y, width, height, board_width, board_height);
 }
 
 la::Transform_Matrix View_Box::set(double width, double height, double board_width, double board_height)
 {
-	return private_set(0, 0, width, height, board_width, board_height);
+	return this->private_set(0, 0, width, height, board_width, board_height);
+}
+
+bool View_Box::contains(la::Board_Vec point) const
+{
+	return point.x >= this->min.x && point.x <= this->max.x 
+	    && point.y >= this->min.y && point.y <= this->max.y;
+}
+
+bool View_Box::clip(la::Board_Vec& start, la::Board_Vec& end) const
+{
+	const la::Board_Vec direction = end - start;
+	//the line is start + t * direction for t in [0, 1]. for every edge p * t <= q has to hold to be on the inner side of it.
+	const double p[4] = { -direction.x, direction.x, -direction.y, direction.y };
+	const double q[4] = { start.x - this->min.x, this->max.x - start.x, start.y - this->min.y, this->max.y - start.y };
+	double t_enter = 0.0;
+	double t_leave = 1.0;
+	for (int edge = 0; edge < 4; edge++) {
+		if (p[edge] == 0.0) {	//line is parallel to edge
+			if (q[edge] < 0.0) {
+				return false;
+			}
+		}
+		else {
+			const double t = q[edge] / p[edge];
+			if (p[edge] < 0.0) {
+				if (t > t_leave) {
+					return false;
+				}
+				t_enter = std::max(t_enter, t);
+			}
+			else {
+				if (t < t_enter) {
+					return false;
+				}
+				t_leave = std::min(t_leave, t);
+			}
+		}
+	}
+	const la::Board_Vec original_start = start;
+	if (t_enter > 0.0) {
+		start = original_start + t_enter * direction;
+	}
+	if (t_leave < 1.0) {
+		end = original_start + t_leave * direction;
+	}
+	return true;
+}
+
+bool View_Box::all_outside(std::initializer_list<la::Board_Vec> points) const
+{
+	bool left = true, right = true, above = true, below = true;
+	for (const la::Board_Vec point : points) {
+		left  = left  && point.x < this->min.x;
+		right = right && point.x > this->max.x;
+		above = above && point.y < this->min.y;
+		below = below && point.y > this->max.y;
+	}
+	return left || right || above || below;
+}
+
+
+void Output_Buffer::flush()
+{
+	if (this->flush_sink != nullptr) {
+		this->flush_sink(this->sink, *this);
+	}
+	else {
+		for (std::size_t i = 0; i < this->size; i++) {
+			std::cout << (this->pen_down[i] ? "------" : "  ->  ") << la::Board_Vec(this->x[i], this->y[i]) << '\n';
+		}
+	}
+	this->size = 0;
+}
+
+//appends point to output buffer
+inline void append(Output_Buffer& output_buffer, la::Board_Vec point, bool pen_down)
+{
+	if (output_buffer.size == Output_Buffer::capacity) {
+		output_buffer.flush();
+	}
+	output_buffer.x[output_buffer.size] = point.x;
+	output_buffer.y[output_buffer.size] = point.y;
+	output_buffer.pen_down[output_buffer.size] = pen_down;
+	output_buffer.size++;
+}
+
+void Converter_Context::set_max_deviation(double new_max_deviation)
+{
+	assert(new_max_deviation >= 0.0);
+	this->max_deviation = new_max_deviation;
+}
+
+void Converter_Context::set_motor_distance(double new_motor_distance, la::Vec2D new_wall_offset, double new_line_deviation)
+{
+	assert(new_motor_distance >= 0.0 && new_line_deviation > 0.0);
+	this->motor_distance = new_motor_distance;
+	this->wall_offset = new_wall_offset;
+	this->line_deviation = new_line_deviation;
+}
+
+void Converter_Context::save_draw_to(la::Board_Vec point)
+{
+	la::Board_Vec start = this->prev_point;
+	la::Board_Vec end = point;
+	const bool visible = this->view_box.clip(start, end);
+	if (visible) {
+		if (!this->prev_in_output || !(start == this->prev_point)) {
+			append(this->output, start, false);
+		}
+		append(this->output, end, true);
+	}
+	this->prev_in_output = visible && end == point;
+	this->prev_point = point;
 }
 
-bool View_Box::contains(la::Board_Vec point)
+void Converter_Context::save_go_to(la::Board_Vec point)
 {
-	return point.x > View_Box::min.x && point.x < View_Box::max.x 
-	    && point.y > View_Box::min.y && point.y < View_Box::max.y;
+	const bool next_in_view_box = this->view_box.contains(point);
+	if (next_in_view_box) {
+		append(this->output, point, false);
+	}
+	this->prev_in_output = next_in_view_box;
+	this->prev_point = point;
 }
 
 
@@ -164,14 +378,98 @@ std::string read::string_from_file(const char* file_name)
 	return str;
 }
 
+read::Mapped_File::Mapped_File(const char* file_name)
+{
+#ifdef _WIN32
+	this->file_handle = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (this->file_handle == INVALID_HANDLE_VALUE) {
+		throw std::runtime_error("function read::Mapped_File::Mapped_File(): could not open file.");
+	}
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(this->file_handle, &file_size)) {
+		CloseHandle(this->file_handle);
+		throw std::runtime_error("function read::Mapped_File::Mapped_File(): could not open file.");
+	}
+	this->size = static_cast<std::size_t>(file_size.QuadPart);
+	if (this->size > 0) {	//empty files can not be mapped
+		this->mapping_handle = CreateFileMappingA(this->file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (this->mapping_handle == nullptr) {
+			CloseHandle(this->file_handle);
+			throw std::runtime_error("function read::Mapped_File::Mapped_File(): could not map file.");
+		}
+		this->data = static_cast<const char*>(MapViewOfFile(this->mapping_handle, FILE_MAP_READ, 0, 0, 0));
+		if (this->data == nullptr) {
+			CloseHandle(this->mapping_handle);
+			CloseHandle(this->file_handle);
+			throw std::runtime_error("function read::Mapped_File::Mapped_File(): could not map file.");
+		}
+	}
+#else
+	std::FILE* const file = std::fopen(file_name, "rb");
+	struct stat file_stat;
+	if (file == nullptr || fstat(fileno(file), &file_stat) < 0) {
+		if (file != nullptr) {
+			std::fclose(file);
+		}
+		throw std::runtime_error("function read::Mapped_File::Mapped_File(): could not open file.");
+	}
+	this->size = static_cast<std::size_t>(file_stat.st_size);
+	if (this->size > 0) {	//empty files can not be mapped
+		void* const mapped = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+		if (mapped == MAP_FAILED) {
+			std::fclose(file);
+			throw std::runtime_error("function read::Mapped_File::Mapped_File(): could not map file.");
+		}
+		madvise(mapped, this->size, MADV_SEQUENTIAL);	//the tokenizer reads from front to back
+		this->data = static_cast<const char*>(mapped);
+	}
+	std::fclose(file);	//the mapping stays valid
+#endif
+}
+
+read::Mapped_File::~Mapped_File()
+{
+#ifdef _WIN32
+	if (this->data != nullptr) {
+		UnmapViewOfFile(this->data);
+		CloseHandle(this->mapping_handle);
+	}
+	CloseHandle(this->file_handle);
+#else
+	if (this->data != nullptr) {
+		munmap(const_cast<char*>(this->data), this->size);
+	}
+#endif
+}
+
+double read::motor_distance_from_config(const char* file_name)
+{
+	std::ifstream config(file_name);
+	char name;
+	double motor_distance;
+	if (config >> name >> motor_distance && name == 'W' && motor_distance > 0.0) {
+		return motor_distance;
+	}
+	return 0.0;
+}
+
 void read::preprocess_str(std::string& str)
 {
-	std::size_t comment_start = str.find("<!--");
-	while (comment_start != std::string::npos) {
-		const std::size_t comment_length = str.find("-->", comment_start) - comment_start + std::strlen("-->");
-		str.erase(comment_start, comment_length);
-		comment_start = str.find("<!--", comment_start);
+	//the parts in between comments are moved to the front in a single pass (erasing every comment would move the rest every time)
+	std::size_t kept_length = 0;
+	std::size_t next_kept = 0;
+	while (next_kept < str.length()) {
+		const std::size_t comment_start = str.find("<!--", next_kept);
+		const std::size_t kept_end = comment_start != std::string::npos ? comment_start : str.length();
+		std::copy(str.begin() + next_kept, str.begin() + kept_end, str.begin() + kept_length);
+		kept_length += kept_end - next_kept;
+		if (comment_start == std::string::npos) {
+			break;
+		}
+		const std::size_t comment_end = str.find("-->", comment_start + std::strlen("<!--"));
+		next_kept = comment_end != std::string::npos ? comment_end + std::strlen("-->") : str.length();
 	}
+	str.resize(kept_length);
 
 	bool inside_quotes = false;	//currently only used for checking if svg is valid
 	bool inside_elem = false;
@@ -216,61 +514,232 @@ std::string_view read::name_of(Elem_Type type)
 	return {};
 }
 
-std::size_t read::find_skip_quotations(std::string_view search_zone, std::string_view search_obj, std::size_t start)
+read::Token read::take_next_attribute(std::string_view& view)
 {
-	std::size_t next_quotation_start = search_zone.find_first_of("\"'", start);
-	std::size_t prev_quotation_end = start;
+	const std::size_t name_start = skip_spaces(view);
+	if (name_start == view.length()) {
+		view = "";
+		return { Token_Type::end, "", "" };
+	}
+	std::size_t name_end = name_start;
+	while (name_end < view.length() && view[name_end] != '=' && !is_space(view[name_end])) {
+		name_end++;
+	}
+	const std::string_view name = { view.data() + name_start, name_end - name_start };
 
-	while (next_quotation_start != std::string::npos) {
-		const std::string_view search_section = { search_zone.data() + prev_quotation_end, next_quotation_start - prev_quotation_end + 1 };	//including the opening quote itself with + 1
-		const std::size_t found = search_section.find(search_obj);
-		if (found != std::string::npos) {
-			return found + prev_quotation_end;	//search_section has offset of prev_quotation_end from search_zone.
+	const std::size_t equals_sign = skip_spaces(view, name_end);
+	if (equals_sign == view.length() || view[equals_sign] != '=') {	//attribute without value (not valid svg, but we do not need to crash)
+		view.remove_prefix(name_end);
+		return { Token_Type::attribute, name, "" };
+	}
+	const std::size_t opening_quote = skip_spaces(view, equals_sign + 1);
+	if (opening_quote == view.length() || (view[opening_quote] != '\"' && view[opening_quote] != '\'')) {
+		throw std::runtime_error("function read::take_next_attribute(): value of attribute is not given in quotes.");
+	}
+	const std::size_t closing_quote = view.find(view[opening_quote], opening_quote + 1);
+	if (closing_quote == std::string::npos) {
+		throw std::runtime_error("function read::take_next_attribute(): quotation (using \"\" or '') was started, but not ended.");
+	}
+	const std::string_view value = in_between(view, opening_quote, closing_quote);
+	view.remove_prefix(closing_quote + 1);
+	return { Token_Type::attribute, name, value };
+}
+
+read::Tokenizer::Tokenizer(std::string_view document)
+	:rest(document)
+{
+}
+
+read::Token read::Tokenizer::next()
+{
+	if (this->attributes.length()) {
+		const Token attribute = take_next_attribute(this->attributes);
+		if (attribute.type != Token_Type::end) {
+			return attribute;
+		}
+	}
+	if (this->self_closing) {
+		this->self_closing = false;
+		return { Token_Type::elem_end, this->open_name, "" };
+	}
+
+	while (this->rest.length()) {
+		const std::size_t open_bracket = this->rest.find('<');
+		if (open_bracket != 0) {	//text in front of next element
+			const std::string_view text = shorten_to(this->rest, std::min(open_bracket, this->rest.length()));
+			this->rest.remove_prefix(text.length());
+			if (skip_spaces(text) != text.length()) {
+				return { Token_Type::text, "", text };
+			}
+			continue;
+		}
+
+		if (this->rest.compare(0, std::strlen("<!--"), "<!--") == 0) {
+			const std::size_t comment_end = this->rest.find("-->", std::strlen("<!--"));
+			if (comment_end == std::string::npos) {
+				throw std::runtime_error("function read::Tokenizer::next(): comment was started with \"<!--\", but not ended.");
+			}
+			this->rest.remove_prefix(comment_end + std::strlen("-->"));
 		}
-		prev_quotation_end = search_zone.find_first_of("\"'", next_quotation_start + 1);
-		if (prev_quotation_end == std::string::npos) {
-			throw std::exception("function read::find_skip_quotations(): quotation (using \"\" or '') was started, but not ended.");
+		else if (this->rest.compare(0, std::strlen("<![CDATA["), "<![CDATA[") == 0) {
+			const std::size_t cdata_end = this->rest.find("]]>", std::strlen("<![CDATA["));
+			if (cdata_end == std::string::npos) {
+				throw std::runtime_error("function read::Tokenizer::next(): CDATA section was started, but not ended.");
+			}
+			this->rest.remove_prefix(cdata_end + std::strlen("]]>"));
+		}
+		else if (this->rest.length() > 1 && (this->rest[1] == '?' || this->rest[1] == '!')) {	//"<?xml ... ?>" or "<!DOCTYPE ... >"
+			this->rest.remove_prefix(find_tag_end(this->rest, 1) + 1);
+		}
+		else if (this->rest.length() > 1 && this->rest[1] == '/') {	//"</g>"
+			const std::size_t tag_end = find_tag_end(this->rest, 2);
+			std::size_t name_end = 2;
+			while (name_end < tag_end && !is_space(this->rest[name_end])) {
+				name_end++;
+			}
+			const std::string_view name = in_between(this->rest, 1, name_end);
+			this->rest.remove_prefix(tag_end + 1);
+			return { Token_Type::elem_end, name, "" };
+		}
+		else {	//"<circle ...>" or "<circle .../>"
+			const std::size_t tag_end = find_tag_end(this->rest, 1);
+			std::size_t name_end = 1;
+			while (name_end < tag_end && !is_space(this->rest[name_end]) && this->rest[name_end] != '/') {
+				name_end++;
+			}
+			this->open_name = in_between(this->rest, 0, name_end);
+			this->self_closing = this->rest[tag_end - 1] == '/';
+			const std::size_t attributes_end = this->self_closing ? tag_end - 1 : tag_end;
+			this->attributes = { this->rest.data() + name_end, attributes_end - std::min(name_end, attributes_end) };
+			this->rest.remove_prefix(tag_end + 1);
+			return { Token_Type::elem_start, this->open_name, this->attributes };
 		}
-		next_quotation_start = search_zone.find_first_of("\"'", prev_quotation_end + 1);
 	}
+	return { Token_Type::end, "", "" };
+}
 
-	return search_zone.find(search_obj, prev_quotation_end);
+std::string_view read::Tokenizer::unread() const
+{
+	return this->rest;
 }
 
-std::string_view read::get_attribute_data(std::string_view search_zone, std::string_view attr_name)
+std::string_view read::name_of(Attribute attribute)
 {
-	std::size_t found = find_skip_quotations(search_zone, attr_name);
-	while (found != std::string::npos) {
-		//this is very trashy and may be changed later. i am aware of that
-		if (found != 0 && (search_zone[found - 1] == ' ' || search_zone[found - 1] == ',') || found == 0) {	//guarantee that attr_name is not just suffix of some other atribute
-			search_zone.remove_prefix(found + attr_name.length() + 1);
+	switch (attribute) {
+	case Attribute::x:			return { "x" };
+	case Attribute::y:			return { "y" };
+	case Attribute::x1:			return { "x1" };
+	case Attribute::y1:			return { "y1" };
+	case Attribute::x2:			return { "x2" };
+	case Attribute::y2:			return { "y2" };
+	case Attribute::width:		return { "width" };
+	case Attribute::height:		return { "height" };
+	case Attribute::cx:			return { "cx" };
+	case Attribute::cy:			return { "cy" };
+	case Attribute::r:			return { "r" };
+	case Attribute::rx:			return { "rx" };
+	case Attribute::ry:			return { "ry" };
+	case Attribute::points:		return { "points" };
+	case Attribute::d:			return { "d" };
+	case Attribute::transform:	return { "transform" };
+	case Attribute::view_box:	return { "viewBox" };
+	case Attribute::unknown:	return { "unknown" };
+	}
+	assert(false);	//if this assert is hit, you may update the switchcase above.
+	return {};
+}
 
-			const size_t closing_quote = search_zone.find_first_of("\"'");
-			return shorten_to(search_zone, closing_quote);
+Attribute read::attribute_of(std::string_view name)
+{
+	for (Attribute attribute : all_attributes) {
+		if (name == name_of(attribute)) {
+			return attribute;
 		}
-		search_zone.remove_prefix(found + 1); 
-		found = find_skip_quotations(search_zone, attr_name);
 	}
-	return { "" };
+	return Attribute::unknown;
 }
 
-std::vector<double> read::from_csv(std::string_view csv, bool always_comma)
+read::Attributes::Attributes(std::string_view content)
 {
-	std::vector<double> result;
-	result.reserve(std::count_if(csv.begin(), csv.end(), [](char c) { return c == ' ' || c == ','; }) + 1);
-
-	std::size_t next_value_start = csv.find_first_of("0123456789.+-");
-	while (next_value_start != std::string::npos) {
-		std::size_t next_seperator = csv.find_first_of((always_comma? "," : ", -"), next_value_start + 1);	//minus may also be used as seperator
-		if (next_seperator != std::string::npos && csv[next_seperator - 1] == 'e') {	//if true, next_seperator points at '-' in something like "100e-4", witch is undesired
-			next_seperator = csv.find_first_of((always_comma ? "," : ", -"), next_seperator + 1);
+	for (Token attribute = take_next_attribute(content); attribute.type != Token_Type::end; attribute = take_next_attribute(content)) {
+		const Attribute known = attribute_of(attribute.name);
+		if (known != Attribute::unknown) {
+			this->values[static_cast<std::size_t>(known)] = attribute.value;	//all_attributes lists the attributes in the order of their declaration
 		}
-		const std::string_view next_value = in_between(csv, next_value_start - 1, next_seperator);
-		result.push_back(to_scaled(next_value));
-		next_value_start = csv.find_first_of("0123456789.+-", next_seperator);
 	}
+}
 
-	return result;
+std::string_view read::Attributes::operator[](Attribute attribute) const
+{
+	assert(attribute != Attribute::unknown);
+	return this->values[static_cast<std::size_t>(attribute)];
+}
+
+read::Number_Scanner::Number_Scanner(std::string_view csv)
+	:current(csv.data()), end(csv.data() + csv.length())
+{
+}
+
+bool read::Number_Scanner::next(double& result)
+{
+	this->current = skip_number_seperators(this->current, this->end);
+	const char* number_start = this->current;
+	if (number_start != this->end && *number_start == '+') {	//std::from_chars() does not accept a leading plus
+		number_start++;
+	}
+	//std::from_chars() stops in front of a '-' not belonging to an exponent, hence "10-20" is read as 10 first and -20 afterwards.
+	const auto [number_end, error] = std::from_chars(number_start, this->end, result);
+	if (error == std::errc::invalid_argument) {
+		return false;
+	}
+	if (error == std::errc::result_out_of_range) {	//result is not written then: too small numbers become 0, too big ones the biggest double
+		const bool negative = *number_start == '-';
+		const char* const exponent = std::find_if(number_start, number_end, [](char c) { return c == 'e' || c == 'E'; });
+		const bool too_small = exponent != number_end && exponent + 1 != number_end && exponent[1] == '-';
+		const double magnitude = too_small ? 0.0 : std::numeric_limits<double>::max();
+		result = negative ? -magnitude : magnitude;
+	}
+	this->current = number_end;
+	return true;
+}
+
+std::size_t read::Number_Scanner::next(double* buffer, std::size_t capacity)
+{
+	std::size_t count = 0;
+	while (count < capacity && this->next(buffer[count])) {
+		count++;
+	}
+	return count;
+}
+
+bool read::Number_Scanner::next_flag(double& result)
+{
+	const char flag = this->peek();
+	if (flag != '0' && flag != '1') {
+		return false;
+	}
+	result = flag == '1' ? 1.0 : 0.0;
+	this->current++;
+	return true;
+}
+
+char read::Number_Scanner::peek()
+{
+	this->current = skip_number_seperators(this->current, this->end);
+	return this->current != this->end ? *this->current : '\0';
+}
+
+void read::Number_Scanner::skip_char()
+{
+	this->current = skip_number_seperators(this->current, this->end);
+	if (this->current != this->end) {
+		this->current++;
+	}
+}
+
+std::string_view read::Number_Scanner::unread() const
+{
+	return { this->current, static_cast<std::size_t>(this->end - this->current) };
 }
 
 std::string_view read::name_of(Unit unit)
@@ -304,148 +773,528 @@ double read::to_scaled(std::string_view name, double default_val)
 	return result;
 }
 
+Elem_Type read::elem_type_of(std::string_view name)
+{
+	for (Elem_Type type : all_elem_types) {
+		if (name == name_of(type)) {
+			return type;
+		}
+	}
+	return Elem_Type::unknown;
+}
+
 Elem_Data read::take_next_elem(std::string_view& view)
 {
-	const std::size_t open_bracket = find_skip_quotations(view, "<");
-	if (open_bracket == std::string::npos) {
+	Tokenizer tokens(view);
+	Token token = tokens.next();
+	while (token.type != Token_Type::elem_start && token.type != Token_Type::end) {
+		token = tokens.next();
+	}
+	view = tokens.unread();
+
+	if (token.type == Token_Type::end) {
 		return { Elem_Type::end, "" };
 	}
-	view.remove_prefix(open_bracket + 1);	//if view started as "\n <circle cx=...", view is "circle cx=..." now 
+	const Elem_Type type = elem_type_of(token.name);
+	return { type, type != Elem_Type::unknown ? token.value : "" };
+}
 
-	for (Elem_Type type : all_elem_types) {
-		const std::string_view type_name = name_of(type);
-		if (view.compare(0, type_name.length(), type_name) == 0) {
-			if (view[type_name.length()] != ' ' && view[type_name.length()] != '>') {
-				continue;	//after the name, there is expected to be a space or the end of the element. is this is not fulfilled, type_name is only prefix of views real type.
+read::Document::Document(std::string_view svg_view)
+	:nodes(1), attribute_tables(1)
+{
+	struct Open_Elem
+	{
+		std::string_view name;
+		Node_Index node;		//no_node if element is of type unknown and therefore not stored
+	};
+	std::vector<Open_Elem> open_elems = { { "", Document::root } };	//the elements not yet closed
+	std::vector<Node_Index> last_child = { no_node };	//last_child[i] is the last child added to nodes[i] so far
+
+	//returns closest ancestor of the next element that is stored in nodes
+	const auto parent_node = [&open_elems]() {
+		auto open = open_elems.rbegin();
+		while (open->node == no_node) {
+			++open;
+		}
+		return open->node;
+	};
+
+	Tokenizer tokens(svg_view);
+	for (Token token = tokens.next(); token.type != Token_Type::end; token = tokens.next()) {
+		if (token.type == Token_Type::elem_start) {
+			const Elem_Type type = elem_type_of(token.name);
+			if (type == Elem_Type::unknown) {
+				open_elems.push_back({ token.name, no_node });
+				continue;
+			}
+			const Node_Index parent = parent_node();
+			const Node_Index index = static_cast<Node_Index>(this->nodes.size());
+			this->nodes.push_back({ type, no_node, no_node });
+			this->attribute_tables.emplace_back(token.value);
+			last_child.push_back(no_node);
+
+			if (last_child[parent] == no_node) {
+				this->nodes[parent].first_child = index;
+			}
+			else {
+				this->nodes[last_child[parent]].next_sibling = index;
+			}
+			last_child[parent] = index;
+			open_elems.push_back({ token.name, index });
+		}
+		else if (token.type == Token_Type::elem_end) {
+			//elements not closed properly are closed together with their parent
+			auto open = std::find_if(open_elems.rbegin(), open_elems.rend() - 1, [&token](const Open_Elem& elem) { return elem.name == token.name; });
+			if (open != open_elems.rend() - 1) {
+				open_elems.erase(std::prev(open.base()), open_elems.end());
 			}
-			view.remove_prefix(type_name.length());		//"circle cx=..." becomes " cx=..."
-			const std::size_t end = find_skip_quotations(view, ">");
-			const std::string_view content = shorten_to(view, end);		//it is just expected that an end marker was found.
-			view.remove_prefix(end + std::strlen(">"));
-			return { type, content };
 		}
 	}
+}
 
-	const std::size_t end = find_skip_quotations(view, ">");
-	view.remove_prefix(end + std::strlen(">"));	//it is just expected that an end marker was found.
-	return { Elem_Type::unknown, "" };
+const read::Node& read::Document::operator[](Node_Index index) const
+{
+	assert(index < this->nodes.size());
+	return this->nodes[index];
 }
 
-void read::evaluate_svg(std::string_view svg_view, double board_width, double board_height)
+const read::Attributes& read::Document::attributes_of(Node_Index index) const
 {
-	la::Transform_Matrix to_board = la::in_matrix_order(1, 0, 0,
-	                                                    0, 1, 0);
-	const std::string_view view_box_data = read::get_attribute_data(svg_view, "viewBox=");
+	assert(index < this->attribute_tables.size());
+	return this->attribute_tables[index];
+}
+
+//sets the view box of context as given by the outhermost svg element of document, returns the matrix from its coordinates to the board
+la::Transform_Matrix set_view_box(Converter_Context& context, const Document& document, double board_width, double board_height)
+{
+	Node_Index root_svg = document[Document::root].first_child;
+	while (root_svg != no_node && document[root_svg].type != Elem_Type::svg) {
+		root_svg = document[root_svg].next_sibling;
+	}
+	const Attributes& root_attributes = document.attributes_of(root_svg != no_node ? root_svg : Document::root);
+
+	const std::string_view view_box_data = root_attributes[Attribute::view_box];
 	if (view_box_data != "") {
-		to_board = View_Box::set(view_box_data, board_width, board_height);
+		return context.view_box.set(view_box_data, board_width, board_height);
 	}
 	else {
-		const double width = read::to_scaled(read::get_attribute_data(svg_view, "width="));
-		const double height = read::to_scaled(read::get_attribute_data(svg_view, "height="));
-		to_board = View_Box::set(width, height, board_width, board_height);
+		const double width = read::to_scaled(root_attributes[Attribute::width]);
+		const double height = read::to_scaled(root_attributes[Attribute::height]);
+		return context.view_box.set(width, height, board_width, board_height);
 	}
-
-	read::evaluate_fragment(svg_view, to_board);
 }
 
-void read::evaluate_fragment(std::string_view fragment, const la::Transform_Matrix& transform)
+//calls on_shape(node, transform) for every shape in the subtree of fragment (in document order), 
+//transform is the matrix from the coordinates of the shape to the board
+template<typename On_Shape>
+void walk_fragment(const Document& document, Node_Index fragment, const la::Transform_Matrix& transform, On_Shape& on_shape)
 {
-	Elem_Data next = take_next_elem(fragment);	//function also removes prefix belonging to next
-	while (next.type != Elem_Type::end) {
-		switch (next.type) {
+	for (Node_Index child = document[fragment].first_child; child != no_node; child = document[child].next_sibling) {
+		const Attributes& attributes = document.attributes_of(child);
+
+		switch (document[child].type) {
 		case Elem_Type::svg:
 			{
-				const std::size_t nested_svg_end = find_closing_elem(fragment, { "<svg" }, { "</svg>" });
-				const std::string_view nested_svg_fragment = { fragment.data(), nested_svg_end };
-
-				const double x_offset = to_scaled(get_attribute_data(next.content, { "x=" }), 0.0);
-				const double y_offset = to_scaled(get_attribute_data(next.content, { "y=" }), 0.0);
+				const double x_offset = to_scaled(attributes[Attribute::x], 0.0);
+				const double y_offset = to_scaled(attributes[Attribute::y], 0.0);
 				const la::Transform_Matrix nested_matrix = transform * la::translate({ x_offset, y_offset });
 
-				evaluate_fragment(nested_svg_fragment, nested_matrix);
-				fragment.remove_prefix(nested_svg_end + std::strlen("</svg>"));
+				walk_fragment(document, child, nested_matrix, on_shape);
 			}
 			break;
 
 		case Elem_Type::g:
 			{
-				const std::size_t group_end = find_closing_elem(fragment, { "<g" }, { "</g>" });
-				const std::string_view group_fragment = { fragment.data(), group_end };
+				const la::Transform_Matrix group_matrix = transform * get_transform_matrix(attributes[Attribute::transform]);
+
+				walk_fragment(document, child, group_matrix, on_shape);
+			}
+			break;
+
+		case Elem_Type::unknown: break;	//unknown elements are not stored in document
+
+		default:
+			on_shape(child, transform);
+		}
+	}
+}
+
+//draws the shape of type with attributes (nothing is drawn if type is not a shape)
+void evaluate_shape(Converter_Context& context, Elem_Type type, const Attributes& attributes, const la::Transform_Matrix& transform)
+{
+	switch (type) {
+	case Elem_Type::line:		draw::line(context, transform, attributes);		break;
+	case Elem_Type::polyline:	draw::polyline(context, transform, attributes);	break;
+	case Elem_Type::polygon:	draw::polygon(context, transform, attributes);	break;
+	case Elem_Type::rect:		draw::rect(context, transform, attributes);		break;
+	case Elem_Type::ellipse:	draw::ellipse(context, transform, attributes);	break;
+	case Elem_Type::circle:		draw::circle(context, transform, attributes);	break;
+	case Elem_Type::path:		draw::path(context, transform, attributes);		break;
+
+	default: break;
+	}
+}
+
+//draws the shape stored in node
+void evaluate_shape(Converter_Context& context, const Document& document, Node_Index node, const la::Transform_Matrix& transform)
+{
+	evaluate_shape(context, document[node].type, document.attributes_of(node), transform);
+}
+
+//the shapes of a document are flattened in tasks of consecutive shapes, every task into its own toolpath.
+//the tasks are handed out to the threads in contiguous ranges: a thread takes the tasks from the front of its own range.
+//if its range is empty, it steals the back half of the biggest range left, until no task is left.
+class Task_Ranges
+{
+	struct Range
+	{
+		std::mutex mutex;
+		std::size_t begin = 0;
+		std::size_t end = 0;
+	};
+	std::unique_ptr<Range[]> ranges;
+	std::size_t thread_count;
+
+public:
+	Task_Ranges(std::size_t task_count, std::size_t thread_count)
+		:ranges(new Range[thread_count]), thread_count(thread_count)
+	{
+		for (std::size_t thread = 0; thread < thread_count; thread++) {
+			this->ranges[thread].begin = task_count * thread / thread_count;
+			this->ranges[thread].end = task_count * (thread + 1) / thread_count;
+		}
+	}
+
+	//sets task to the next task of thread, returns false if all tasks are taken
+	bool next(std::size_t thread, std::size_t& task)
+	{
+		Range& own = this->ranges[thread];
+		while (true) {
+			{
+				std::lock_guard<std::mutex> lock(own.mutex);
+				if (own.begin < own.end) {
+					task = own.begin++;
+					return true;
+				}
+			}
+			std::size_t victim = thread;
+			std::size_t victim_size = 0;
+			for (std::size_t other = 0; other < this->thread_count; other++) {
+				std::lock_guard<std::mutex> lock(this->ranges[other].mutex);
+				const std::size_t size = this->ranges[other].end - this->ranges[other].begin;
+				if (size > victim_size) {
+					victim = other;
+					victim_size = size;
+				}
+			}
+			if (victim_size == 0) {
+				return false;
+			}
+			std::scoped_lock lock(own.mutex, this->ranges[victim].mutex);
+			Range& stolen = this->ranges[victim];
+			if (stolen.begin < stolen.end) {	//victim may have taken its tasks in the meantime
+				const std::size_t middle = stolen.end - (stolen.end - stolen.begin + 1) / 2;
+				own.begin = middle;
+				own.end = stolen.end;
+				stolen.end = middle;
+			}
+		}
+	}
+};
+
+void read::evaluate_svg(Converter_Context& context, std::string_view svg_view, double board_width, double board_height)
+{
+	context.prev_point = la::Board_Vec(0, 0);
+	context.prev_in_output = false;
+
+	const Document document(svg_view);
+	const la::Transform_Matrix to_board = set_view_box(context, document, board_width, board_height);
+	read::evaluate_fragment(context, document, Document::root, to_board);
+}
+
+void read::evaluate_svg_parallel(const Converter_Context& settings, std::string_view svg_view, double board_width, double board_height, 
+	Toolpath& toolpath, std::size_t thread_count)
+{
+	Converter_Context main_context = settings;
+	main_context.output.sink = nullptr;
+	main_context.output.flush_sink = nullptr;
+	if (thread_count <= 1) {
+		read::evaluate_svg(main_context, svg_view, board_width, board_height, toolpath);
+		return;
+	}
+
+	const Document document(svg_view);
+	const la::Transform_Matrix to_board = set_view_box(main_context, document, board_width, board_height);
+
+	struct Shape
+	{
+		Node_Index node;
+		la::Transform_Matrix transform;
+	};
+	std::vector<Shape> shapes;
+	std::size_t total_cost = 0;
+	//the cost of a shape is guessed from the length of its data, so big paths end up in a task of their own
+	auto cost_of = [&document](Node_Index node) {
+		const Attributes& attributes = document.attributes_of(node);
+		return 64 + attributes[Attribute::d].size() + attributes[Attribute::points].size();
+	};
+	auto add_shape = [&](Node_Index node, const la::Transform_Matrix& transform) {
+		shapes.push_back({ node, transform });
+		total_cost += cost_of(node);
+	};
+	walk_fragment(document, Document::root, to_board, add_shape);
+
+	//task i draws shapes[task_starts[i]] to shapes[task_starts[i + 1] - 1]. every thread gets roughly 8 tasks, to be able to balance the load.
+	const std::size_t cost_per_task = total_cost / (8 * thread_count) + 1;
+	std::vector<std::size_t> task_starts = { 0 };
+	std::size_t task_cost = 0;
+	for (std::size_t shape = 0; shape < shapes.size(); shape++) {
+		task_cost += cost_of(shapes[shape].node);
+		if (task_cost >= cost_per_task) {
+			task_starts.push_back(shape + 1);
+			task_cost = 0;
+		}
+	}
+	if (task_starts.back() != shapes.size()) {
+		task_starts.push_back(shapes.size());
+	}
+	const std::size_t task_count = task_starts.size() - 1;
+
+	std::vector<Toolpath> task_toolpaths(task_count);
+	Task_Ranges tasks(task_count, thread_count);
+	auto work = [&](std::size_t thread) {
+		Converter_Context context = main_context;	//every thread has its own output buffer and curve points
+		for (std::size_t task; tasks.next(thread, task); ) {
+			Toolpath& task_toolpath = task_toolpaths[task];
+			context.output.size = 0;
+			context.output.sink = &task_toolpath;
+			context.output.flush_sink = &Output_Buffer::flush_to<Toolpath>;
+			context.prev_point = la::Board_Vec(0, 0);
+			context.prev_in_output = false;
+			for (std::size_t shape = task_starts[task]; shape < task_starts[task + 1]; shape++) {
+				evaluate_shape(context, document, shapes[shape].node, shapes[shape].transform);
+			}
+			context.output.flush();
+		}
+	};
+	std::vector<std::thread> threads;
+	for (std::size_t thread = 1; thread < thread_count; thread++) {
+		threads.emplace_back(work, thread);
+	}
+	work(0);
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
 
-				const la::Transform_Matrix group_matrix = transform * get_transform_matrix(next.content);
+	for (const Toolpath& task_toolpath : task_toolpaths) {
+		toolpath.append(task_toolpath);
+	}
+}
 
-				evaluate_fragment(group_fragment, group_matrix);
-				fragment.remove_prefix(group_end + std::strlen("</g>"));
+//returns the position behind the comment, CDATA section, tag or text starting at view[0].
+//if view ends before that part does, npos is returned (and more of the document has to be read first).
+std::size_t find_part_end(std::string_view view)
+{
+	assert(view.length() > 0);
+	if (view[0] != '<') {
+		return std::min(view.find('<'), view.length());	//text is never drawn, so it may also end with view
+	}
+	const std::pair<std::string_view, std::string_view> skipped_parts[] = { { "<!--", "-->" }, { "<![CDATA[", "]]>" } };
+	for (const auto& [begin, end] : skipped_parts) {
+		if (view.compare(0, begin.length(), begin) == 0) {
+			const std::size_t part_end = view.find(end, begin.length());
+			return part_end != std::string::npos ? part_end + end.length() : std::string::npos;
+		}
+		if (view.length() < begin.length() && begin.compare(0, view.length(), view) == 0) {
+			return std::string::npos;	//can not yet tell, which kind of part starts here
+		}
+	}
+	//same as find_tag_end(), but an unfinished tag is no error
+	std::size_t next = view.find_first_of("\"'>", 1);
+	while (next != std::string::npos && view[next] != '>') {
+		const std::size_t closing_quote = view.find(view[next], next + 1);
+		if (closing_quote == std::string::npos) {
+			return std::string::npos;
+		}
+		next = view.find_first_of("\"'>", closing_quote + 1);
+	}
+	return next != std::string::npos ? next + 1 : std::string::npos;
+}
+
+void read::evaluate_svg_stream(Converter_Context& context, std::istream& input, double board_width, double board_height, std::size_t chunk_size)
+{
+	context.prev_point = la::Board_Vec(0, 0);
+	context.prev_in_output = false;
+
+	//mirrors what Document and walk_fragment() do: unknown elements are transparent, children of shapes are not drawn
+	//and elements not closed properly are closed together with their parent.
+	struct Open_Elem
+	{
+		std::string name;	//copied, as the chunk holding the start tag may be gone when the element is closed
+		la::Transform_Matrix transform;	//from the coordinates of the children to the board
+		bool children_drawn;
+	};
+	std::vector<Open_Elem> open_elems = { { "", la::in_matrix_order(1, 0, 0, 0, 1, 0), true } };
+	bool view_box_set = false;
+
+	//the view box is set by the first svg element. if anything else known comes first, the document is treated as holding no svg element.
+	auto set_view_box_once = [&](Elem_Type type, const Attributes& attributes) {
+		if (view_box_set) {
+			return;
+		}
+		view_box_set = true;
+		const Attributes& root_attributes = type == Elem_Type::svg ? attributes : Attributes();
+		const std::string_view view_box_data = root_attributes[Attribute::view_box];
+		const la::Transform_Matrix to_board = view_box_data != "" ? context.view_box.set(view_box_data, board_width, board_height) :
+			context.view_box.set(to_scaled(root_attributes[Attribute::width]), to_scaled(root_attributes[Attribute::height]), board_width, board_height);
+		for (Open_Elem& open : open_elems) {	//only unknown elements are open yet
+			open.transform = to_board;
+		}
+	};
+
+	auto start_elem = [&](const Token& token) {
+		const Elem_Type type = elem_type_of(token.name);
+		const Open_Elem& parent = open_elems.back();
+		if (type == Elem_Type::unknown || !parent.children_drawn) {
+			open_elems.push_back({ std::string(token.name), parent.transform, parent.children_drawn && type == Elem_Type::unknown });
+			return;
+		}
+		const Attributes attributes(token.value);
+		set_view_box_once(type, attributes);
+		const la::Transform_Matrix& transform = open_elems.back().transform;
+		switch (type) {
+		case Elem_Type::svg:
+			{
+				const double x_offset = to_scaled(attributes[Attribute::x], 0.0);
+				const double y_offset = to_scaled(attributes[Attribute::y], 0.0);
+				open_elems.push_back({ std::string(token.name), transform * la::translate({ x_offset, y_offset }), true });
 			}
 			break;
 
-		case Elem_Type::line:		draw::line(transform, next.content);		break;
-		case Elem_Type::polyline:	draw::polyline(transform, next.content);	break;
-		case Elem_Type::polygon:	draw::polygon(transform, next.content);		break;
-		case Elem_Type::rect:		draw::rect(transform, next.content);		break;
-		case Elem_Type::ellipse:	draw::ellipse(transform, next.content);		break;
-		case Elem_Type::circle:		draw::circle(transform, next.content);		break;
-		case Elem_Type::path:		draw::path(transform, next.content);		break;
+		case Elem_Type::g:
+			open_elems.push_back({ std::string(token.name), transform * get_transform_matrix(attributes[Attribute::transform]), true });
+			break;
+
+		default:
+			evaluate_shape(context, type, attributes, transform);
+			context.output.flush();	//the shape leaves the converter right away
+			open_elems.push_back({ std::string(token.name), transform, false });
+		}
+	};
 
-		case Elem_Type::unknown: break;	//just read in the next element and do nothing
+	auto end_elem = [&](const Token& token) {
+		auto open = std::find_if(open_elems.rbegin(), open_elems.rend() - 1, [&token](const Open_Elem& elem) { return elem.name == token.name; });
+		if (open != open_elems.rend() - 1) {
+			open_elems.erase(std::prev(open.base()), open_elems.end());
 		}
-		next = take_next_elem(fragment);	//function removes prefix belonging to next also
+	};
+
+	//buffer[evaluated, buffer.size()) holds the part of the document read, but not yet evaluated.
+	//only complete parts (tags, comments, ...) are handed to the tokenizer, the rest waits for the next chunk.
+	std::string buffer;
+	std::size_t evaluated = 0;
+	bool input_left = true;
+	while (true) {
+		const std::string_view unread(buffer.data() + evaluated, buffer.size() - evaluated);
+		const std::size_t part_end = unread.length() ? find_part_end(unread) : std::string::npos;
+		if (part_end == std::string::npos) {
+			if (!input_left) {
+				if (skip_spaces(unread) != unread.length()) {
+					throw std::runtime_error("function read::evaluate_svg_stream(): input ended in the middle of a tag.");
+				}
+				break;
+			}
+			buffer.erase(0, evaluated);
+			evaluated = 0;
+			//a part longer than a chunk makes the next read longer too, so it is searched for its end only a few times
+			const std::size_t read_size = std::max(chunk_size, buffer.size());
+			const std::size_t old_size = buffer.size();
+			buffer.resize(old_size + read_size);
+			input.read(buffer.data() + old_size, read_size);
+			buffer.resize(old_size + static_cast<std::size_t>(input.gcount()));
+			input_left = static_cast<bool>(input);
+			continue;
+		}
+
+		Tokenizer tokens(shorten_to(unread, part_end));
+		for (Token token = tokens.next(); token.type != Token_Type::end; token = tokens.next()) {
+			if (token.type == Token_Type::elem_start) {
+				start_elem(token);
+			}
+			else if (token.type == Token_Type::elem_end) {
+				end_elem(token);
+			}
+		}
+		evaluated += part_end;
 	}
+	context.output.flush();
+}
+
+void read::evaluate_fragment(Converter_Context& context, const Document& document, Node_Index fragment, const la::Transform_Matrix& transform)
+{
+	auto draw_shape = [&](Node_Index node, const la::Transform_Matrix& shape_transform) {
+		evaluate_shape(context, document, node, shape_transform);
+	};
+	walk_fragment(document, fragment, transform, draw_shape);
 }
 
-la::Transform_Matrix read::get_transform_matrix(std::string_view group_attributes)
+la::Transform_Matrix read::get_transform_matrix(std::string_view transform_list)
 {
 	la::Transform_Matrix result_matrix = la::in_matrix_order(1, 0, 0,
 		                                                     0, 1, 0);	//starts as identity matrix
 
-	std::string_view transform_list = get_attribute_data(group_attributes, { "transform=" });
+	const char* const seperators = ", \n\t\r";	//the list may also span multiple lines
+	transform_list.remove_prefix(std::min(transform_list.find_first_not_of(seperators), transform_list.length()));
 	while (transform_list.length()) {
+		bool known_transform = false;
 		for (la::Transform transform : la::all_transforms) {
 			const std::string_view name = name_of(transform);
 			if (transform_list.compare(0, name.length(), name) == 0) {
+				known_transform = true;
 				const std::size_t closing_parenthesis = transform_list.find_first_of(')');
 				//name does not include parentheses, but the length is one bigger than the biggest index in name. hence name.length() returns the right number
 				const std::string_view parameter_view = in_between(transform_list, name.length(), closing_parenthesis); 
-				const std::vector<double> parameters = from_csv(parameter_view, true);
+				double parameters[6] = {};	//a matrix has the most parameters of all transformations
+				const std::size_t parameters_count = Number_Scanner(parameter_view).next(parameters, 6);
 
 				switch (transform) {
 				case la::Transform::matrix:
-					assert(parameters.size() == 6);
+					assert(parameters_count == 6);
 					result_matrix = result_matrix * la::Transform_Matrix{ parameters[0], parameters[1], parameters[2], parameters[3], parameters[4], parameters[5] };
 					break;
 				case la::Transform::translate:
-					if (parameters.size() == 2) {
+					if (parameters_count == 2) {
 						result_matrix = result_matrix * la::translate({ parameters[0], parameters[1] });
 					}
 					else {
-						assert(parameters.size() == 1);
+						assert(parameters_count == 1);
 						result_matrix = result_matrix * la::translate({ parameters[0], 0.0 });
 					}
 					break;
 				case la::Transform::scale:
-					if (parameters.size() == 2) {
+					if (parameters_count == 2) {
 						result_matrix = result_matrix * la::scale(parameters[0], parameters[1]);
 					}
 					else {
-						assert(parameters.size() == 1);
+						assert(parameters_count == 1);
 						result_matrix = result_matrix * la::scale(parameters[0], parameters[0]);
 					}
 					break;
 				case la::Transform::rotate:
-					if (parameters.size() == 1) {
+					if (parameters_count == 1) {
 						result_matrix = result_matrix * la::rotate(to_rad(parameters[0]));
 					}
 					else {
-						assert(parameters.size() == 3);
+						assert(parameters_count == 3);
 						result_matrix = result_matrix * la::rotate(to_rad(parameters[0]), { parameters[1], parameters[2] });
 					}
 					break;
 				case la::Transform::skew_x:
-					assert(parameters.size() == 1);
+					assert(parameters_count == 1);
 					result_matrix = result_matrix * la::skew_x(to_rad(parameters[0]));
 					break;
 				case la::Transform::skew_y:
-					assert(parameters.size() == 1);
+					assert(parameters_count == 1);
 					result_matrix = result_matrix * la::skew_y(to_rad(parameters[0]));
 					break;
 				default:
@@ -453,7 +1302,7 @@ la::Transform_Matrix read::get_transform_matrix(std::string_view group_attribute
 				}
 
 				transform_list.remove_prefix(closing_parenthesis + 1);	//all up to closing parenthesis is removed
-				const std::size_t next_not_seperator = transform_list.find_first_not_of(", ");
+				const std::size_t next_not_seperator = transform_list.find_first_not_of(seperators);
 				if (next_not_seperator != std::string::npos) {
 					transform_list.remove_prefix(next_not_seperator);
 				}
@@ -463,6 +1312,9 @@ la::Transform_Matrix read::get_transform_matrix(std::string_view group_attribute
 				break;	//transformation is applied and next transformation may be read in -> breaking for() loop
 			}
 		}
+		if (!known_transform) {
+			break;	//it is not known where an unknown transformation ends, so the rest of the list is ignored
+		}
 	}
 	return result_matrix;
 }
@@ -472,159 +1324,119 @@ la::Transform_Matrix read::get_transform_matrix(std::string_view group_attribute
 
 using namespace path;
 
-Path_Elem_data path::take_next_elem(std::string_view& view)
-{
-	const std::size_t fst_letter_pos = view.find_first_of("MmVvHhLlAaQqTtCcSsZz");
-	if (fst_letter_pos == std::string::npos) {
-		return { "", Path_Elem::end, Coords_Type::absolute };
-	}
-	std::size_t snd_letter_pos = view.find_first_of("MmVvHhLlAaQqTtCcSsZz", fst_letter_pos + 1);
-	std::string_view content = in_between(view, fst_letter_pos, snd_letter_pos);
-	Path_Elem_data result;
-
-	switch (view[fst_letter_pos]) {
-	case 'M': result = { content, Path_Elem::move, Coords_Type::absolute };				break;
-	case 'm': result = { content, Path_Elem::move, Coords_Type::relative };				break;
-	case 'V': result = { content, Path_Elem::vertical_line, Coords_Type::absolute };	break;
-	case 'v': result = { content, Path_Elem::vertical_line, Coords_Type::relative };	break;
-	case 'H': result = { content, Path_Elem::horizontal_line, Coords_Type::absolute };	break;
-	case 'h': result = { content, Path_Elem::horizontal_line, Coords_Type::relative };	break;
-	case 'L': result = { content, Path_Elem::line, Coords_Type::absolute };				break;
-	case 'l': result = { content, Path_Elem::line, Coords_Type::relative };				break;
-	case 'A': result = { content, Path_Elem::arc, Coords_Type::absolute };				break;
-	case 'a': result = { content, Path_Elem::arc, Coords_Type::relative };				break;
-	case 'Q':
-	case 'q':
-	case 'T':
-	case 't':
-		snd_letter_pos = view.find_first_of("MmVvHhLlAaCcSsZz", snd_letter_pos);	//QqTt is missing
-		content = in_between(view, fst_letter_pos - 1, snd_letter_pos);	//-1 as bezier needs to know what kind
-		result = { content, Path_Elem::quadr_bezier, Coords_Type::absolute };		
-		break;
-	case 'C':
-	case 'c':
-	case 'S':
-	case 's':
-		snd_letter_pos = view.find_first_of("MmVvHhLlAaQqTtZz", snd_letter_pos); //CcSs is missing
-		content = in_between(view, fst_letter_pos - 1, snd_letter_pos);	//-1 as bezier needs to know what kind
-		result = { content, Path_Elem::cubic_bezier, Coords_Type::absolute };		
-		break;
-	case 'Z':
-	case 'z':
-		result = { "", Path_Elem::closed, Coords_Type::absolute };
-		break;
-	default:
-		assert(false);
-	}
-
-	if (snd_letter_pos == std::string::npos) view = "";
-	else view.remove_prefix(snd_letter_pos);
-
-	return result;
+path::Path_Parser::Path_Parser(std::string_view path_data)
+	:numbers(path_data)
+{
 }
 
-la::Vec2D path::process_quadr_bezier(const la::Transform_Matrix& transform_matrix, Path_Elem_data data, la::Vec2D current_point)
+Path_Command path::Path_Parser::next()
 {
-	Bezier_Data curve = take_next_bezier(data.content);
-	la::Vec2D last_control_point = la::Vec2D::no_value;
-	while (curve.content != "") {
-		const std::vector<double> points = from_csv(curve.content);
-
-		if (curve.control_data == Control_Given::expl) {
-			assert(points.size() % 4 == 0);
-
-			for (std::size_t i = 0; i < points.size(); i += 4) {
-				const la::Vec2D control = curve.coords_type == Coords_Type::absolute ?
-					la::Vec2D{ points[i], points[i + 1] } :
-					current_point + la::Vec2D{ points[i], points[i + 1] };
-
-				const la::Vec2D end = curve.coords_type == Coords_Type::absolute ?
-					la::Vec2D{ points[i + 2], points[i + 3] } :
-					current_point + la::Vec2D{ points[i + 2], points[i + 3] };
-
-				draw::quadr_bezier(transform_matrix * current_point, transform_matrix * control, transform_matrix * end);
-				current_point = end;
-				last_control_point = control;	//not used in this loop, but the loop for implicit control points (below)
-			}
-		}
-		if (curve.control_data == Control_Given::impl) {
-			assert(points.size() % 2 == 0);
-			if (last_control_point == la::Vec2D::no_value) {
-				last_control_point = current_point;	//current_point is also current position
-			}
-
-			for (std::size_t i = 0; i < points.size(); i += 2) {
-				const la::Vec2D control = compute_contol_point(last_control_point, current_point);
-
-				const la::Vec2D end = curve.coords_type == Coords_Type::absolute ?
-					la::Vec2D{ points[i], points[i + 1] } :
-					current_point + la::Vec2D{ points[i], points[i + 1] };
+	const char next_char = this->numbers.peek();
+	if (next_char == '\0') {
+		return {};
+	}
+	if (std::isalpha(static_cast<unsigned char>(next_char))) {
+		this->letter = next_char;
+		this->numbers.skip_char();
+	}
+	else if (this->letter == 'M') {	//numbers following a move are implicit line commands
+		this->letter = 'L';
+	}
+	else if (this->letter == 'm') {
+		this->letter = 'l';
+	}
 
-				draw::quadr_bezier(transform_matrix * current_point, transform_matrix * control, transform_matrix * end);
-				current_point = end;
-				last_control_point = control;
-			}
+	Path_Command result;
+	result.coords_type = std::islower(static_cast<unsigned char>(this->letter)) ? Coords_Type::relative : Coords_Type::absolute;
+	std::size_t args_count = 0;
+
+	switch (this->letter) {
+	case 'M': case 'm': result.type = Path_Elem::move;				args_count = 2;	break;
+	case 'V': case 'v': result.type = Path_Elem::vertical_line;		args_count = 1;	break;
+	case 'H': case 'h': result.type = Path_Elem::horizontal_line;	args_count = 1;	break;
+	case 'L': case 'l': result.type = Path_Elem::line;				args_count = 2;	break;
+	case 'Q': case 'q': result.type = Path_Elem::quadr_bezier;		args_count = 4;	break;
+	case 'T': case 't': result.type = Path_Elem::quadr_bezier;		args_count = 2;	result.control_data = Control_Given::impl;	break;
+	case 'C': case 'c': result.type = Path_Elem::cubic_bezier;		args_count = 6;	break;
+	case 'S': case 's': result.type = Path_Elem::cubic_bezier;		args_count = 4;	result.control_data = Control_Given::impl;	break;
+	case 'Z': case 'z': 
+		result.type = Path_Elem::closed;	
+		this->letter = '\0';	//numbers directly after closing the path are an error
+		return result;
+	case 'A': case 'a':
+		result.type = Path_Elem::arc;
+		//the two flags may be written without seperator in between, hence they are read as single characters
+		if (this->numbers.next(result.args, 3) == 3 && this->numbers.next_flag(result.args[3]) && this->numbers.next_flag(result.args[4]) &&
+			this->numbers.next(result.args + 5, 2) == 2) {
+			return result;
 		}
+		return {};
+	default:	//either an unknown letter or numbers without a command in front: following w3, everything up to the error is drawn
+		return {};
+	}
 
-		curve = take_next_bezier(data.content);
+	if (this->numbers.next(result.args, args_count) != args_count) {
+		return {};
 	}
-	return current_point;
+	return result;
 }
 
-la::Vec2D path::process_cubic_bezier(const la::Transform_Matrix& transform_matrix, Path_Elem_data data, la::Vec2D current_point)
+path::Segment_Reader::Segment_Reader(std::string_view path_data)
+	:commands(path_data)
 {
-	Bezier_Data curve = take_next_bezier(data.content);
-	la::Vec2D last_control_point = la::Vec2D::no_value;
-	while (curve.content != "") {
-		const std::vector<double> points = from_csv(curve.content);
-
-		if (curve.control_data == Control_Given::expl) {
-			assert(points.size() % 6 == 0);
-
-			for (std::size_t i = 0; i < points.size(); i += 6) {
-				const la::Vec2D control_1 = curve.coords_type == Coords_Type::absolute ?
-					la::Vec2D{ points[i], points[i + 1] } :
-					current_point + la::Vec2D{ points[i], points[i + 1] };
+}
 
-				const la::Vec2D control_2 = curve.coords_type == Coords_Type::absolute ?
-					la::Vec2D{ points[i + 2], points[i + 3] } :
-					current_point + la::Vec2D{ points[i + 2], points[i + 3] };
+Path_Segment path::Segment_Reader::next()
+{
+	Path_Segment segment;
+	segment.command = this->commands.next();
+	segment.type = segment.command.type;
+	segment.start = this->current_point;
+
+	//relative coordinates are given relative to the current point
+	const la::Vec2D origin = segment.command.coords_type == Coords_Type::absolute ? la::Vec2D{ 0.0, 0.0 } : this->current_point;
+	const double* const args = segment.command.args;
+	const bool explicit_control = segment.command.control_data == Control_Given::expl;
+
+	//an implicit control point is mirrored from the last one only if the previous command was a curve of the same degree
+	if (segment.type != this->last_type) {
+		this->last_control_point = this->current_point;
+	}
 
-				const la::Vec2D end = curve.coords_type == Coords_Type::absolute ?
-					la::Vec2D{ points[i + 4], points[i + 5] } :
-					current_point + la::Vec2D{ points[i + 4], points[i + 5] };
+	switch (segment.type) {
+	case Path_Elem::move:
+		segment.end = origin + la::Vec2D{ args[0], args[1] };
+		this->current_subpath_begin = segment.end;
+		break;
+	case Path_Elem::vertical_line:		segment.end = { this->current_point.x, origin.y + args[0] };	break;
+	case Path_Elem::horizontal_line:	segment.end = { origin.x + args[0], this->current_point.y };	break;
+	case Path_Elem::line:				segment.end = origin + la::Vec2D{ args[0], args[1] };			break;
+	case Path_Elem::arc:				segment.end = origin + la::Vec2D{ args[5], args[6] };			break;
+	case Path_Elem::closed:				segment.end = this->current_subpath_begin;						break;
+
+	case Path_Elem::quadr_bezier:
+		segment.control_1 = explicit_control ? origin + la::Vec2D{ args[0], args[1] } : compute_contol_point(this->last_control_point, this->current_point);
+		segment.end = explicit_control ? origin + la::Vec2D{ args[2], args[3] } : origin + la::Vec2D{ args[0], args[1] };
+		this->last_control_point = segment.control_1;
+		break;
 
-				draw::cubic_bezier(transform_matrix * current_point, transform_matrix * control_1, transform_matrix * control_2, transform_matrix * end);
-				current_point = end;
-				last_control_point = control_2;	//not used in this loop, but the loop for implicit control points (below)
-			}
+	case Path_Elem::cubic_bezier:
+		{
+			segment.control_1 = explicit_control ? origin + la::Vec2D{ args[0], args[1] } : compute_contol_point(this->last_control_point, this->current_point);
+			//if the first control point is given implicitly, the following points start two numbers earlier
+			const std::size_t i = explicit_control ? 2 : 0;
+			segment.control_2 = origin + la::Vec2D{ args[i], args[i + 1] };
+			segment.end = origin + la::Vec2D{ args[i + 2], args[i + 3] };
+			this->last_control_point = segment.control_2;
 		}
-		if (curve.control_data == Control_Given::impl) {
-			assert(points.size() % 4 == 0);
-			if (last_control_point == la::Vec2D::no_value) {
-				last_control_point = current_point;
-			}
-
-			for (std::size_t i = 0; i < points.size(); i += 4) {
-				const la::Vec2D control_1 = compute_contol_point(last_control_point, current_point);
-
-				const la::Vec2D control_2 = curve.coords_type == Coords_Type::absolute ?
-					la::Vec2D{ points[i], points[i + 1] } :
-					current_point + la::Vec2D{ points[i], points[i + 1] };
-
-				const la::Vec2D end = curve.coords_type == Coords_Type::absolute ?
-					la::Vec2D{ points[i + 2], points[i + 3] } :
-					current_point + la::Vec2D{ points[i + 2], points[i + 3] };
+		break;
 
-				draw::cubic_bezier(transform_matrix * current_point, transform_matrix * control_1, transform_matrix * control_2, transform_matrix * end);
-				current_point = end;
-				last_control_point = control_2;
-			}
-		}
-		curve = take_next_bezier(data.content);
+	case Path_Elem::end:
+		return segment;
 	}
-
-	return current_point;
+	this->current_point = segment.end;
+	this->last_type = segment.type;
+	return segment;
 }
 
 la::Vec2D path::compute_contol_point(la::Vec2D last_control_point, la::Vec2D mirror)
@@ -632,129 +1444,123 @@ la::Vec2D path::compute_contol_point(la::Vec2D last_control_point, la::Vec2D mir
 	return 2.0 * mirror - last_control_point;
 }
 
-Bezier_Data path::take_next_bezier(std::string_view& view)
+la::Vec2D path::process_arc(Converter_Context& context, const la::Transform_Matrix& transform_matrix, const Path_Command& command, la::Vec2D current_point)
 {
-	const std::size_t identifier_pos = view.find_first_of("CcQqTtSs");
-	if (identifier_pos == std::string::npos) {
-		return { "", Control_Given::expl, Coords_Type::absolute };
+	const double* const args = command.args;
+
+	double rx = std::abs(args[0]);			//needs to be able to be updated if to small
+	double ry = std::abs(args[1]);			//needs to be able to be updated if to small
+	const double phi = to_rad(std::fmod(args[2], 360.0));		//phi is often called x_axis_rotation by w3
+	const bool large_arc_flag = args[3];	//w3 says any nonzero value is meant as true
+	const bool sweep_flag = args[4];
+	const double x2 = command.coords_type == Coords_Type::absolute ? args[5] : current_point.x + args[5];
+	const double y2 = command.coords_type == Coords_Type::absolute ? args[6] : current_point.y + args[6];
+
+	const double x1 = current_point.x;	//names as in reference
+	const double y1 = current_point.y;
+
+	//the following is taken from here: https://www.w3.org/TR/SVG11/implnote.html#ArcImplementationNotes
+
+	//going from  x1 y1 x2 y2 fA fS rx ry phi  to  cx cy theta1 delta theta: (described a little down on that side)
+
+	const double cos_phi = std::cos(phi);
+	const double sin_phi = std::sin(phi);
+
+	//step 1:
+	const auto [x1_prime, y1_prime] = la::Matrix2X2{ cos_phi, sin_phi,
+	                                                -sin_phi, cos_phi } *la::Vec2D{ (x1 - x2) / 2,
+	                                                                                            (y1 - y2) / 2 };
+	//error correction for to small radii:
+	const double lambda = (x1_prime * x1_prime) / (rx * rx) + (y1_prime * y1_prime) / (ry * ry);
+	if (lambda > 1.0) {
+		rx *= std::sqrt(lambda);
+		ry *= std::sqrt(lambda);
 	}
-	const std::size_t next_pos = view.find_first_of("CcQqTtSs", identifier_pos + 1);
-	const std::string_view content = in_between(view, identifier_pos, next_pos);
-	const char identifier = view[identifier_pos];
 
-	if (next_pos == std::string::npos) {
-		view = "";
+	//step 2:
+	const double rx2 = rx * rx;						//the 2s stand for squared
+	const double ry2 = ry * ry;
+	const double x1_prime2 = x1_prime * x1_prime;
+	const double y1_prime2 = y1_prime * y1_prime;
+	const double sign = large_arc_flag != sweep_flag ? 1.0 : -1.0;
+	const la::Vec2D center_prime = sign * std::sqrt(std::abs((rx2 * ry2 - rx2 * y1_prime2 - ry2 * x1_prime2) / 	//in an ideal world abs() is not needed, but negative values may arise from rounding errors.
+	                                                          (rx2 * y1_prime2 + ry2 * x1_prime2)))       * la::Vec2D{ rx * y1_prime / ry,
+	                                                                                                                  -ry * x1_prime / rx	};
+	//step 3:
+	const la::Vec2D center = la::Matrix2X2{ cos_phi, -sin_phi,
+	                                        sin_phi,  cos_phi } * center_prime + la::Vec2D{ (x1 + x2) / 2,
+	                                                                                                    (y1 + y2) / 2 };
+	//step 4:	
+	const la::Vec2D v1 = la::Vec2D{ (x1_prime - center_prime.x) / rx,
+						        	(y1_prime - center_prime.y) / ry };
+	const la::Vec2D v2 = la::Vec2D{ (-x1_prime - center_prime.x) / rx,
+						        	(-y1_prime - center_prime.y) / ry };
+	const double start_angle = angle({ 1, 0 }, v1);			//called theta 1 by w3
+	double delta_angle = angle(v1, v2);		                //called delta theta by w3
+	if (large_arc_flag) {
+		delta_angle += (delta_angle > 0 ? -2 * la::pi : 2 * la::pi);	//function angle() is guaranteed to return a value in interval (-pi, pi]
 	}
-	else {
-		view.remove_prefix(next_pos);
-	}
-	switch (identifier) {
-	case 'C': case 'Q': return { content, Control_Given::expl, Coords_Type::absolute };
-	case 'c': case 'q':	return { content, Control_Given::expl, Coords_Type::relative };
-	case 'T': case 'S':	return { content, Control_Given::impl, Coords_Type::absolute };
-	case 't': case 's':	return { content, Control_Given::impl, Coords_Type::relative };
+	if (sweep_flag == (delta_angle < 0)) {	//either sweep_flag is set and delta_angle is smaller than 0 or both are false to enter the condition
+		delta_angle *= -1;
 	}
-	assert(false);
-	return { "", Control_Given::expl, Coords_Type::absolute };
-}
-
-la::Vec2D path::process_arc(const la::Transform_Matrix& transform_matrix, Path_Elem_data data, la::Vec2D current_point)
-{
-	const std::vector<double> points = from_csv(data.content);	//data would be a better name than points, but this name is already taken.
-	assert(points.size() % 7 == 0);
 
-	for (std::size_t i = 0; i < points.size(); i += 7) {
-		double rx = std::abs(points[i]);			//needs to be able to be updated if to small
-		double ry = std::abs(points[i + 1]);		//needs to be able to be updated if to small
-		const double phi = to_rad(std::fmod(points[i + 2], 360.0));		//phi is often called x_axis_rotation by w3
-		const bool large_arc_flag = points[i + 3];	//w3 says any nonzero value is meant as true
-		const bool sweep_flag = points[i + 4];
-		const double x2 = data.coords_type == Coords_Type::absolute ? points[i + 5] : current_point.x + points[i + 5];
-		const double y2 = data.coords_type == Coords_Type::absolute ? points[i + 6] : current_point.y + points[i + 6];
+	const la::Transform_Matrix from_arc_coordinates = transform_matrix * la::rotate(cos_phi, sin_phi, center);
+	draw::arc(context, from_arc_coordinates, center, rx, ry, start_angle, delta_angle);
 
-		const double x1 = current_point.x;	//names as in reference
-		const double y1 = current_point.y;
+	return { x2, y2 };
+}
 
-		//the following is taken from here: https://www.w3.org/TR/SVG11/implnote.html#ArcImplementationNotes
 
-		//going from  x1 y1 x2 y2 fA fS rx ry phi  to  cx cy theta1 delta theta: (described a little down on that side)
 
-		//step 1:
-		const auto [x1_prime, y1_prime] = la::Matrix2X2{ std::cos(phi), std::sin(phi),
-		                                                -std::sin(phi), std::cos(phi) } *la::Vec2D{ (x1 - x2) / 2,
-		                                                                                            (y1 - y2) / 2 };
-		//error correction for to small radii:
-		const double lambda = (x1_prime * x1_prime) / (rx * rx) + (y1_prime * y1_prime) / (ry * ry);
-		if (lambda > 1.0) {
-			rx *= std::sqrt(lambda);
-			ry *= std::sqrt(lambda);
-		}
 
-		//step 2:
-		const double rx2 = rx * rx;						//the 2s stand for squared
-		const double ry2 = ry * ry;
-		const double x1_prime2 = x1_prime * x1_prime;
-		const double y1_prime2 = y1_prime * y1_prime;
-		const double sign = large_arc_flag != sweep_flag ? 1.0 : -1.0;
-		const la::Vec2D center_prime = sign * std::sqrt(std::abs((rx2 * ry2 - rx2 * y1_prime2 - ry2 * x1_prime2) / 	//in an ideal world abs() is not needed, but negative values may arise from rounding errors.
-		                                                          (rx2 * y1_prime2 + ry2 * x1_prime2)))       * la::Vec2D{ rx * y1_prime / ry,
-		                                                                                                                  -ry * x1_prime / rx	};
-		//step 3:
-		const la::Vec2D center = la::Matrix2X2{ std::cos(phi), -std::sin(phi),
-		                                        std::sin(phi),  std::cos(phi) } * center_prime + la::Vec2D{ (x1 + x2) / 2,
-		                                                                                                    (y1 + y2) / 2 };
-		//step 4:	
-		const la::Vec2D v1 = la::Vec2D{ (x1_prime - center_prime.x) / rx,
-							        	(y1_prime - center_prime.y) / ry };
-		const la::Vec2D v2 = la::Vec2D{ (-x1_prime - center_prime.x) / rx,
-							        	(-y1_prime - center_prime.y) / ry };
-		const double start_angle = angle({ 1, 0 }, v1);			//called theta 1 by w3
-		double delta_angle = angle(v1, v2);		                //called delta theta by w3
-		if (large_arc_flag) {
-			delta_angle += (delta_angle > 0 ? -2 * la::pi : 2 * la::pi);	//function angle() is guaranteed to return a value in interval (-pi, pi]
-		}
-		if (sweep_flag == (delta_angle < 0)) {	//either sweep_flag is set and delta_angle is smaller than 0 or both are false to enter the condition
-			delta_angle *= -1;
-		}
+using namespace draw;
 
-		const la::Transform_Matrix from_arc_coordinates = transform_matrix * la::rotate(phi, center);
-		draw::arc(from_arc_coordinates, center, rx, ry, start_angle, delta_angle);
-		current_point = { x2, y2 };
+//draws to all points of context.curve_points
+void draw_curve_points(Converter_Context& context)
+{
+	const flatten::Point_Batch& batch = context.curve_points;
+	for (std::size_t i = 0; i < batch.size; i++) {
+		context.save_draw_to(la::Board_Vec(batch.x[i], batch.y[i]));
 	}
-
-	return current_point;
 }
 
+//returns in how many pieces a curve is split: resolution if no max_deviation is set in context, else the amount computed from the curves shape.
+//steps_needed(max_deviation) is only called, if max_deviation is set.
+template<typename Steps_Needed>
+std::size_t curve_resolution(const Converter_Context& context, std::size_t resolution, Steps_Needed steps_needed)
+{
+	if (context.max_deviation <= 0.0) {
+		return resolution;
+	}
+	const double steps = std::ceil(steps_needed(context.max_deviation));
+	return steps >= 1.0 ? static_cast<std::size_t>(steps) : 1;	//also catches nan (from degenerate curves)
+}
 
-
-
-using namespace draw;
-
-void draw::line(la::Transform_Matrix transform_matrix, std::string_view parameters, std::size_t resolution)
+void draw::line(Converter_Context& context, la::Transform_Matrix transform_matrix, const read::Attributes& attributes, std::size_t resolution)
 {
-	transform_matrix = transform_matrix * read::get_transform_matrix(parameters);
+	transform_matrix = transform_matrix * read::get_transform_matrix(attributes[read::Attribute::transform]);
 
-	const double x1 = read::to_scaled(read::get_attribute_data(parameters, { "x1=" }), 0.0);
-	const double y1 = read::to_scaled(read::get_attribute_data(parameters, { "y1=" }), 0.0);
-	const double x2 = read::to_scaled(read::get_attribute_data(parameters, { "x2=" }), 0.0);
-	const double y2 = read::to_scaled(read::get_attribute_data(parameters, { "y2=" }), 0.0);
+	const double x1 = read::to_scaled(attributes[read::Attribute::x1], 0.0);
+	const double y1 = read::to_scaled(attributes[read::Attribute::y1], 0.0);
+	const double x2 = read::to_scaled(attributes[read::Attribute::x2], 0.0);
+	const double y2 = read::to_scaled(attributes[read::Attribute::y2], 0.0);
 
 	const la::Board_Vec start = transform_matrix * la::Vec2D{ x1, y1 };
 	const la::Board_Vec end = transform_matrix * la::Vec2D{ x2, y2 };
-	save_go_to(start);
-	linear_bezier(start, end);
+	context.save_go_to(start);
+	linear_bezier(context, start, end);
 }
 
-void draw::rect(la::Transform_Matrix transform_matrix, std::string_view parameters, std::size_t resolution)
+void draw::rect(Converter_Context& context, la::Transform_Matrix transform_matrix, const read::Attributes& attributes, std::size_t resolution)
 {
-	transform_matrix = transform_matrix * read::get_transform_matrix(parameters);
+	transform_matrix = transform_matrix * read::get_transform_matrix(attributes[read::Attribute::transform]);
 
-	const double x = read::to_scaled(read::get_attribute_data(parameters, { "x=" }), 0.0);
-	const double y = read::to_scaled(read::get_attribute_data(parameters, { "y=" }), 0.0);
-	const double width = read::to_scaled(read::get_attribute_data(parameters, { "width=" }), 0.0);
-	const double height = read::to_scaled(read::get_attribute_data(parameters, { "height=" }), 0.0);
-	double rx = read::to_scaled(read::get_attribute_data(parameters, { "rx=" }), 0.0);
-	double ry = read::to_scaled(read::get_attribute_data(parameters, { "ry=" }), 0.0);
+	const double x = read::to_scaled(attributes[read::Attribute::x], 0.0);
+	const double y = read::to_scaled(attributes[read::Attribute::y], 0.0);
+	const double width = read::to_scaled(attributes[read::Attribute::width], 0.0);
+	const double height = read::to_scaled(attributes[read::Attribute::height], 0.0);
+	double rx = read::to_scaled(attributes[read::Attribute::rx], 0.0);
+	double ry = read::to_scaled(attributes[read::Attribute::ry], 0.0);
 
 	if (rx != 0 && ry == 0) ry = rx;
 	if (rx == 0 && ry != 0) rx = ry;
@@ -775,11 +1581,11 @@ void draw::rect(la::Transform_Matrix transform_matrix, std::string_view paramete
 		//           |         |
 		//            ---(3)---
 		
-		save_go_to(upper_right);								    //start
-		linear_bezier(upper_right, upper_left, resolution);			//(1)
-		linear_bezier(upper_left, lower_left, resolution);			//(2)
-		linear_bezier(lower_left, lower_right, resolution);			//(3)
-		linear_bezier(lower_right, upper_right, resolution);		//(4)
+		context.save_go_to(upper_right);								    //start
+		linear_bezier(context, upper_right, upper_left, resolution);			//(1)
+		linear_bezier(context, upper_left, lower_left, resolution);			//(2)
+		linear_bezier(context, lower_left, lower_right, resolution);			//(3)
+		linear_bezier(context, lower_right, upper_right, resolution);		//(4)
 	}
 	else {	//draw rectangle with corners rounded of
 		//these two points are the center point of the upper right ellipse (arc) and the lower left ellipse respectively
@@ -802,215 +1608,186 @@ void draw::rect(la::Transform_Matrix transform_matrix, std::string_view paramete
 		//note: as the y-values become bigger, as one goes down, we have a negative rotation when drawing the rectangle as we do.
 		//also: the command (2) and (6) have starting angles one would intuitively change the sign of because of the y-axis direction
 
-		save_go_to(transform_matrix * la::Vec2D{ right_x, upper_y - ry });															 //start
-		linear_bezier(transform_matrix * la::Vec2D{ right_x, upper_y - ry }, transform_matrix * la::Vec2D{ left_x, upper_y - ry });	 //(1)
-		arc(transform_matrix, { left_x, upper_y }, rx, ry, -la::pi / 2, -la::pi / 2);                                                //(2)
-		linear_bezier(transform_matrix * la::Vec2D{ left_x - rx, upper_y }, transform_matrix * la::Vec2D{ left_x - rx, lower_y });	 //(3)
-		arc(transform_matrix, { left_x, lower_y }, rx, ry, la::pi, -la::pi / 2);	                                                 //(4)
-		linear_bezier(transform_matrix * la::Vec2D{ left_x, lower_y + ry }, transform_matrix * la::Vec2D{ right_x, lower_y + ry });	 //(5)
-		arc(transform_matrix, { right_x, lower_y }, rx, ry, la::pi / 2, -la::pi / 2);	                                             //(6)
-		linear_bezier(transform_matrix * la::Vec2D{ right_x + rx, lower_y }, transform_matrix * la::Vec2D{ right_x + rx, upper_y }); //(7)
-		arc(transform_matrix, { right_x, upper_y }, rx, ry, 0, -la::pi / 2);														 //(8)
+		context.save_go_to(transform_matrix * la::Vec2D{ right_x, upper_y - ry });															 //start
+		linear_bezier(context, transform_matrix * la::Vec2D{ right_x, upper_y - ry }, transform_matrix * la::Vec2D{ left_x, upper_y - ry });	 //(1)
+		arc(context, transform_matrix, { left_x, upper_y }, rx, ry, -la::pi / 2, -la::pi / 2);                                                //(2)
+		linear_bezier(context, transform_matrix * la::Vec2D{ left_x - rx, upper_y }, transform_matrix * la::Vec2D{ left_x - rx, lower_y });	 //(3)
+		arc(context, transform_matrix, { left_x, lower_y }, rx, ry, la::pi, -la::pi / 2);	                                                 //(4)
+		linear_bezier(context, transform_matrix * la::Vec2D{ left_x, lower_y + ry }, transform_matrix * la::Vec2D{ right_x, lower_y + ry });	 //(5)
+		arc(context, transform_matrix, { right_x, lower_y }, rx, ry, la::pi / 2, -la::pi / 2);	                                             //(6)
+		linear_bezier(context, transform_matrix * la::Vec2D{ right_x + rx, lower_y }, transform_matrix * la::Vec2D{ right_x + rx, upper_y }); //(7)
+		arc(context, transform_matrix, { right_x, upper_y }, rx, ry, 0, -la::pi / 2);														 //(8)
 	}
 }
 
-void draw::circle(la::Transform_Matrix transform_matrix, std::string_view parameters, std::size_t resolution)
+void draw::circle(Converter_Context& context, la::Transform_Matrix transform_matrix, const read::Attributes& attributes, std::size_t resolution)
 {
-	transform_matrix = transform_matrix * read::get_transform_matrix(parameters);
+	transform_matrix = transform_matrix * read::get_transform_matrix(attributes[read::Attribute::transform]);
 
-	const double cx = read::to_scaled(read::get_attribute_data(parameters, { "cx=" }), 0.0);
-	const double cy = read::to_scaled(read::get_attribute_data(parameters, { "cy=" }), 0.0);
-	const double r  = read::to_scaled(read::get_attribute_data(parameters, { "r=" }), 0.0);
+	const double cx = read::to_scaled(attributes[read::Attribute::cx], 0.0);
+	const double cy = read::to_scaled(attributes[read::Attribute::cy], 0.0);
+	const double r  = read::to_scaled(attributes[read::Attribute::r], 0.0);
 
-	save_go_to(transform_matrix * (la::Vec2D{ cx, cy } +la::Vec2D{ r, 0.0 }));	//intersection of positive x-axis and circle is starting point
-	for (std::size_t step = 1; step <= resolution; step++) {
-		const double angle = 2 * la::pi * (resolution - step) / static_cast<double>(resolution);
-		save_draw_to(transform_matrix * la::Vec2D{ cx + std::cos(angle) * r, cy + std::sin(angle) * r });
-	}
+	context.save_go_to(transform_matrix * (la::Vec2D{ cx, cy } +la::Vec2D{ r, 0.0 }));	//intersection of positive x-axis and circle is starting point
+	arc(context, transform_matrix, { cx, cy }, r, r, 0.0, -2 * la::pi, resolution);
 }
 
-void draw::ellipse(la::Transform_Matrix transform_matrix, std::string_view parameters, std::size_t resolution)
+void draw::ellipse(Converter_Context& context, la::Transform_Matrix transform_matrix, const read::Attributes& attributes, std::size_t resolution)
 {
-	transform_matrix = transform_matrix * read::get_transform_matrix(parameters);
+	transform_matrix = transform_matrix * read::get_transform_matrix(attributes[read::Attribute::transform]);
 
-	const double cx = read::to_scaled(read::get_attribute_data(parameters, { "cx=" }), 0.0);
-	const double cy = read::to_scaled(read::get_attribute_data(parameters, { "cy=" }), 0.0);
-	const double rx = read::to_scaled(read::get_attribute_data(parameters, { "rx=" }), 0.0);
-	const double ry = read::to_scaled(read::get_attribute_data(parameters, { "ry=" }), 0.0);
+	const double cx = read::to_scaled(attributes[read::Attribute::cx], 0.0);
+	const double cy = read::to_scaled(attributes[read::Attribute::cy], 0.0);
+	const double rx = read::to_scaled(attributes[read::Attribute::rx], 0.0);
+	const double ry = read::to_scaled(attributes[read::Attribute::ry], 0.0);
 
-	save_go_to(transform_matrix * (la::Vec2D{ cx, cy } + la::Vec2D{ rx, 0.0 }));	//intersection of positive x-axis and ellipse is starting point
-	for (std::size_t step = 1; step <= resolution; step++) {
-		const double angle = 2 * la::pi * (resolution - step) / static_cast<double>(resolution);
-		save_draw_to(transform_matrix * la::Vec2D{ cx + std::cos(angle) * rx, cy + std::sin(angle) * ry });
-	}
+	context.save_go_to(transform_matrix * (la::Vec2D{ cx, cy } + la::Vec2D{ rx, 0.0 }));	//intersection of positive x-axis and ellipse is starting point
+	arc(context, transform_matrix, { cx, cy }, rx, ry, 0.0, -2 * la::pi, resolution);
 }
 
-void draw::polyline(la::Transform_Matrix transform_matrix, std::string_view parameters, std::size_t resolution)
+void draw::polyline(Converter_Context& context, la::Transform_Matrix transform_matrix, const read::Attributes& attributes, std::size_t resolution)
 {
-	transform_matrix = transform_matrix * read::get_transform_matrix(parameters);
+	transform_matrix = transform_matrix * read::get_transform_matrix(attributes[read::Attribute::transform]);
 
-	const std::string_view points_view = get_attribute_data(parameters, { "points=" });
-	const std::vector<double> points = from_csv(points_view);
-	assert(points.size() % 2 == 0);
+	Number_Scanner numbers(attributes[read::Attribute::points]);
+	double point[2];
+	if (numbers.next(point, 2) != 2) {
+		return;
+	}
 
-	la::Board_Vec start = transform_matrix * la::Vec2D{ points[0], points[1] };
-	save_go_to(start);
-	for (std::size_t i = 2; i < points.size(); i += 2) {
-		const la::Board_Vec end = transform_matrix * la::Vec2D{ points[i], points[i + 1] };
-		linear_bezier(start, end);
+	la::Board_Vec start = transform_matrix * la::Vec2D{ point[0], point[1] };
+	context.save_go_to(start);
+	while (numbers.next(point, 2) == 2) {
+		const la::Board_Vec end = transform_matrix * la::Vec2D{ point[0], point[1] };
+		linear_bezier(context, start, end);
 		start = end;
 	}
 }
 
-void draw::polygon(la::Transform_Matrix transform_matrix, std::string_view parameters, std::size_t resolution)
+void draw::polygon(Converter_Context& context, la::Transform_Matrix transform_matrix, const read::Attributes& attributes, std::size_t resolution)
 {
-	transform_matrix = transform_matrix * read::get_transform_matrix(parameters);
+	transform_matrix = transform_matrix * read::get_transform_matrix(attributes[read::Attribute::transform]);
 
-	const std::string_view points_view = get_attribute_data(parameters, { "points=" });
-	const std::vector<double> points = from_csv(points_view);
-	assert(points.size() % 2 == 0);
+	Number_Scanner numbers(attributes[read::Attribute::points]);
+	double point[2];
+	if (numbers.next(point, 2) != 2) {
+		return;
+	}
 
-	la::Board_Vec start = transform_matrix * la::Vec2D{ points[0], points[1] };
-	la::Board_Vec end(0, 0);
-	save_go_to(start);
-	for (std::size_t i = 2; i < points.size(); i += 2) {
-		end = transform_matrix * la::Vec2D{ points[i], points[i + 1] };
-		linear_bezier(start, end);
+	const la::Board_Vec first = transform_matrix * la::Vec2D{ point[0], point[1] };
+	la::Board_Vec start = first;
+	context.save_go_to(start);
+	while (numbers.next(point, 2) == 2) {
+		const la::Board_Vec end = transform_matrix * la::Vec2D{ point[0], point[1] };
+		linear_bezier(context, start, end);
 		start = end;
 	}
-	end = transform_matrix * la::Vec2D{ points[0], points[1] };	//polygon is closed -> last operation is to connect to first point
-	linear_bezier(start, end);
+	linear_bezier(context, start, first);	//polygon is closed -> last operation is to connect to first point
 }
 
-void draw::path(la::Transform_Matrix transform_matrix, std::string_view parameters, std::size_t resolution)
+void draw::path(Converter_Context& context, la::Transform_Matrix transform_matrix, const read::Attributes& attributes, std::size_t resolution)
 {
-	transform_matrix = transform_matrix * read::get_transform_matrix(parameters);
-
-	std::string_view data_view = get_attribute_data(parameters, { "d=" });
-	la::Vec2D current_point = { 0.0, 0.0 };	//as a path always continues from the last point, this is the point the last path element ended (this is not yet transformed)
-	la::Vec2D current_subpath_begin = { 0.0, 0.0 };	//called initial point by w3
-	Path_Elem_data next_elem = path::take_next_elem(data_view);
-
-	while (next_elem.type != Path_Elem::end) {
-		std::vector<double> data;
-		if (next_elem.type != Path_Elem::quadr_bezier && next_elem.type != Path_Elem::cubic_bezier) {
-			data = from_csv(next_elem.content);
-		}
+	transform_matrix = transform_matrix * read::get_transform_matrix(attributes[read::Attribute::transform]);
 
-		switch (next_elem.type) {
+	Segment_Reader segments(attributes[read::Attribute::d]);
+	for (Path_Segment segment = segments.next(); segment.type != Path_Elem::end; segment = segments.next()) {
+		switch (segment.type) {
 		case Path_Elem::move:
-			assert(data.size() % 2 == 0);
-			{
-				//only the first two coordinates are moved to, the rest are implicit line commands
-				const la::Vec2D next_point = next_elem.coords_type == Coords_Type::absolute ?
-					la::Vec2D{ data[0], data[1] } :
-					current_point + la::Vec2D{ data[0], data[1] };
-				save_go_to(transform_matrix * next_point);
-				current_point = next_point;
-				current_subpath_begin = current_point;
-			}
-			for (std::size_t i = 2; i < data.size(); i += 2) {
-				const la::Vec2D next_point = next_elem.coords_type == Coords_Type::absolute ?
-					la::Vec2D{ data[i], data[i + 1] } :
-					current_point + la::Vec2D{ data[i], data[i + 1] };
-				draw::linear_bezier(transform_matrix * current_point, transform_matrix * next_point);
-				current_point = next_point;
-			}
+			context.save_go_to(transform_matrix * segment.end);
 			break;
 
 		case Path_Elem::vertical_line:
-			{
-				//although that makes no sense, there can be multiple vertical lines stacked -> we directly draw to the end
-				const la::Vec2D next_point = next_elem.coords_type == Coords_Type::absolute ?
-					la::Vec2D{ current_point.x, data.back() } :
-					la::Vec2D{ current_point.x, current_point.y + data.back() };
-				draw::linear_bezier(transform_matrix * current_point, transform_matrix * next_point);
-				current_point = next_point;
-			}
-			break;
-
 		case Path_Elem::horizontal_line:
-			{
-				//although that makes no sense, there can be multiple horizontal lines stacked -> we directly draw to the end
-				const la::Vec2D next_point = next_elem.coords_type == Coords_Type::absolute ?
-					la::Vec2D{ data.back(), current_point.y } :
-					la::Vec2D{ current_point.x + data.back(), current_point.y };
-				draw::linear_bezier(transform_matrix * current_point, transform_matrix * next_point);
-				current_point = next_point;
-			}
-			break;
-
 		case Path_Elem::line:
-			assert(data.size() % 2 == 0);
-			{
-				la::Vec2D next_point = { 0.0, 0.0 };
-				for (std::size_t i = 0; i < data.size(); i += 2) {
-					next_point = next_elem.coords_type == Coords_Type::absolute ?
-						la::Vec2D{ data[i], data[i + 1] } :
-						current_point + la::Vec2D{ data[i], data[i + 1] };
-					draw::linear_bezier(transform_matrix * current_point, transform_matrix * next_point);
-					current_point = next_point;
-				}
-			}
+		case Path_Elem::closed:
+			draw::linear_bezier(context, transform_matrix * segment.start, transform_matrix * segment.end);
 			break;
 
 		case Path_Elem::arc: 
-			current_point = process_arc(transform_matrix, next_elem, current_point);
+			process_arc(context, transform_matrix, segment.command, segment.start);
 			break;
 		case Path_Elem::quadr_bezier: 
-			current_point = process_quadr_bezier(transform_matrix, next_elem, current_point);
+			draw::quadr_bezier(context, transform_matrix * segment.start, transform_matrix * segment.control_1, transform_matrix * segment.end);
 			break;
 		case Path_Elem::cubic_bezier:
-			current_point = process_cubic_bezier(transform_matrix, next_elem, current_point);
+			draw::cubic_bezier(context, transform_matrix * segment.start, transform_matrix * segment.control_1, 
+				transform_matrix * segment.control_2, transform_matrix * segment.end);
 			break;
-		case Path_Elem::closed:
-			draw::linear_bezier(transform_matrix * current_point, transform_matrix * current_subpath_begin);
-			current_point = current_subpath_begin;
+		case Path_Elem::end:
 			break;
 		}
-		next_elem = path::take_next_elem(data_view);
 	}
 }
 
-void draw::arc(const la::Transform_Matrix& transform_matrix, la::Vec2D center, double rx, double ry, double start_angle, double delta_angle, std::size_t resolution)
+void draw::arc(Converter_Context& context, const la::Transform_Matrix& transform_matrix, la::Vec2D center, double rx, double ry, double start_angle, double delta_angle, std::size_t resolution)
 {
-	const double angle_per_step = delta_angle / resolution;
-
-	for (std::size_t step = 1; step <= resolution; step++) {
-		const double angle = start_angle + angle_per_step * step;
-		save_draw_to(transform_matrix * la::Vec2D{ center.x + std::cos(angle) * rx, center.y + std::sin(angle) * ry });
+	{
+		//the transformed ellipse is origin + cos(angle) * x_axis + sin(angle) * y_axis, 
+		//its extent along a coordinate is the length of the vector of that coordinate of x_axis and y_axis.
+		const la::Board_Vec origin = transform_matrix * center;
+		const la::Board_Vec extent(std::hypot(transform_matrix.a * rx, transform_matrix.c * ry), std::hypot(transform_matrix.b * rx, transform_matrix.d * ry));
+		if (context.view_box.all_outside({ origin - extent, origin + extent })) {
+			const double end_angle = start_angle + delta_angle;
+			context.save_go_to(transform_matrix * la::Vec2D{ center.x + std::cos(end_angle) * rx, center.y + std::sin(end_angle) * ry });
+			return;
+		}
 	}
+	resolution = curve_resolution(context, resolution, [&](double deviation) {
+		//a chord spanning the angle alpha on a circle with radius r is at most r * (1 - cos(alpha / 2)) away from the circle.
+		//for an ellipse this holds with the biggest radius, as long as the angle is taken in parameter space (as done below).
+		const double board_radius = std::max(rx, ry) * la::max_stretch(transform_matrix);
+		if (deviation >= board_radius) {
+			return std::abs(delta_angle) / la::pi;	//no more than two steps for a full ellipse, as opposite points have to be reached
+		}
+		const double angle_per_step = 2 * std::acos(1 - deviation / board_radius);
+		return std::abs(delta_angle) / angle_per_step;
+	});
+	flatten::ellipse_arc(transform_matrix, center, rx, ry, start_angle, delta_angle, resolution, context.curve_points);
+	draw_curve_points(context);
 }
 
-void draw::linear_bezier(la::Board_Vec start, la::Board_Vec end, std::size_t resolution)
+void draw::linear_bezier(Converter_Context& context, la::Board_Vec start, la::Board_Vec end, std::size_t resolution)
 {
+	if (context.view_box.all_outside({ start, end })) {
+		context.save_go_to(end);
+		return;
+	}
+	if (context.motor_distance > 0.0) {	//split for the cables later, as every other line (see optimize::Cable_Splitter)
+		context.save_draw_to(end);
+		return;
+	}
 	for (std::size_t step = 1; step <= resolution; step++) {
 		//as given in wikipedia for linear bezier curves: https://en.wikipedia.org/wiki/B%C3%A9zier_curve#Linear_B%C3%A9zier_curves
 		const double t = step / static_cast<double>(resolution);
-		save_draw_to(start + t * (end - start));
+		context.save_draw_to(start + t * (end - start));
 	}
 }
 
-void draw::quadr_bezier(la::Board_Vec start, la::Board_Vec control, la::Board_Vec end, std::size_t resolution)
+void draw::quadr_bezier(Converter_Context& context, la::Board_Vec start, la::Board_Vec control, la::Board_Vec end, std::size_t resolution)
 {
-	for (std::size_t step = 1; step <= resolution; step++) {
-		//formula taken from https://en.wikipedia.org/wiki/B%C3%A9zier_curve#Quadratic_B%C3%A9zier_curves
-		const double t = step / static_cast<double>(resolution);
-		const la::Board_Vec waypoint = (1 - t) * (1 - t) * start + 2 * (1 - t) * t * control + t * t * end;
-		save_draw_to(waypoint);
+	if (context.view_box.all_outside({ start, control, end })) {
+		context.save_go_to(end);
+		return;
 	}
+	resolution = curve_resolution(context, resolution, [&](double deviation) {
+		//bound from Wang's formula: n steps keep the deviation below degree * (degree - 1) / 8 * max|second difference of control points| / n^2
+		return std::sqrt(2.0 / 8.0 * la::abs(start - 2 * control + end) / deviation);
+	});
+	flatten::quadr(start, control, end, resolution, context.curve_points);
+	draw_curve_points(context);
 }
 
-void draw::cubic_bezier(la::Board_Vec start, la::Board_Vec control_1, la::Board_Vec control_2, la::Board_Vec end, std::size_t resolution)
+void draw::cubic_bezier(Converter_Context& context, la::Board_Vec start, la::Board_Vec control_1, la::Board_Vec control_2, la::Board_Vec end, std::size_t resolution)
 {
-	for (std::size_t step = 1; step <= resolution; step++) {
-		//formula taken from https://en.wikipedia.org/wiki/B%C3%A9zier_curve#Cubic_B%C3%A9zier_curves
-		const double t = step / static_cast<double>(resolution);
-		const double tpow2 = t * t;
-		const double onet = (1 - t);
-		const double onetpow2 = onet * onet;
-		const la::Board_Vec waypoint = onetpow2 * (onet * start + 3 * t * control_1) + tpow2 * (3 * onet * control_2 + t * end);
-		//const la::Vec2D waypoint = (1 - t) * (1 - t) * (1 - t) * start + 3 * (1 - t) * (1 - t) * t * control_1 + 3 * (1 - t) * t * t * control_2 + t * t * t * end; //<- equivalent function
-		save_draw_to(waypoint);
+	if (context.view_box.all_outside({ start, control_1, control_2, end })) {
+		context.save_go_to(end);
+		return;
 	}
+	resolution = curve_resolution(context, resolution, [&](double deviation) {
+		//see quadr_bezier()
+		const double second_difference = std::max(la::abs(start - 2 * control_1 + control_2), la::abs(control_1 - 2 * control_2 + end));
+		return std::sqrt(6.0 / 8.0 * second_difference / deviation);
+	});
+	flatten::cubic(start, control_1, control_2, end, resolution, context.curve_points);
+	draw_curve_points(context);
 }
@@ -5,8 +5,15 @@
 #include <vector>
 #include <string>
 #include <string_view>
+#include <cstdint>
+#include <limits>
+#include <iterator>
+#include <initializer_list>
+#include <iosfwd>
 
 #include "linearAlgebra.hpp"
+#include "flattening.hpp"
+#include "toolpath.hpp"
 
 //the svg standard allows for view boxes to be defined inside other view boxes.
 //this forces an implementation of the complete standard to check every coordinate transformation, if we are still within the view box.
@@ -14,21 +21,106 @@
 //i therefore only track the outhermost view box.
 class View_Box
 {
-	static la::Board_Vec min;	//upper left corner of box
-	static la::Board_Vec max;	//lower right corner of box
+	la::Board_Vec min = la::Board_Vec(0, 0);		//upper left corner of box
+	la::Board_Vec max = la::Board_Vec(100, 100);	//lower right corner of box (default values get replaced by set() anyway)
 
 	//called by public set functions
-	static la::Transform_Matrix private_set(double min_x, double min_y, double width, double height, double board_width, double board_height);
+	la::Transform_Matrix private_set(double min_x, double min_y, double width, double height, double board_width, double board_height);
 
 public:
 
 	//sets view box to have aspect ratio as described in data, but stored in Board units (mm)
 	//the transformation matrix from the outhermost svg coordinate system to the board is returned
-	static la::Transform_Matrix set(std::string_view data, double board_width, double board_height);
-	static la::Transform_Matrix set(double width, double height, double board_width, double board_height);
+	la::Transform_Matrix set(std::string_view data, double board_width, double board_height);
+	la::Transform_Matrix set(double width, double height, double board_width, double board_height);
 
-	//checks if point is contained within view box
-	static bool contains(la::Board_Vec point);
+	//checks if point is contained within view box (border included)
+	bool contains(la::Board_Vec point) const;
+
+	//clips the line from start to end to the part inside the view box, see https://en.wikipedia.org/wiki/Liang%E2%80%93Barsky_algorithm
+	//returns false if no part of the line is inside, else start and end are moved to the ends of the part inside.
+	bool clip(la::Board_Vec& start, la::Board_Vec& end) const;
+
+	//returns true if all points lie beyond the same edge of the view box. 
+	//as a curve stays within the convex hull of its control points, no part of it is visible then.
+	bool all_outside(std::initializer_list<la::Board_Vec> points) const;
+};
+
+
+//points leave the converter in chunks: Converter_Context::save_draw_to() and save_go_to() only store them in the output buffer.
+//whenever the buffer is full (and after a document is evaluated), all points are handed to the current sink at once.
+//a sink is any type with member functions draw_to(la::Board_Vec) and go_to(la::Board_Vec).
+//as the loop over the buffer is instantiated for the type of the sink (see read::evaluate_svg()), 
+//the sink is called without std::function or virtual functions and can be inlined.
+struct Output_Buffer
+{
+	static constexpr std::size_t capacity = 4096;
+
+	double x[capacity];
+	double y[capacity];
+	bool pen_down[capacity];	//false: go to point, true: draw to point
+	std::size_t size = 0;
+
+	void* sink = nullptr;	//if no sink is set, the points are printed to std::cout
+	void (*flush_sink)(void* sink, const Output_Buffer& buffer) = nullptr;
+
+	//hands all points stored to the sink and empties buffer
+	void flush();
+
+	//calls sink.draw_to() or sink.go_to() for every point stored
+	template<typename Sink>
+	static void flush_to(void* sink, const Output_Buffer& buffer);
+};
+
+//adapts two functions (e.g. lambdas) to be used as sink
+template<typename Draw_To, typename Go_To>
+struct Function_Sink
+{
+	Draw_To& draw_to_function;
+	Go_To& go_to_function;
+
+	void draw_to(la::Board_Vec point) { this->draw_to_function(point); }
+	void go_to(la::Board_Vec point) { this->go_to_function(point); }
+};
+
+//everything converting a document changes or reads, besides the document itself.
+//as nothing is shared between contexts, multiple documents can be converted at once (e.g. on different threads),
+//as long as every conversion uses its own context. a context can be reused for the next document.
+struct Converter_Context
+{
+	View_Box view_box;
+	Output_Buffer output;
+
+	la::Board_Vec prev_point = la::Board_Vec(0, 0);	//last point given to save_draw_to() or save_go_to(), even if it was outside the view box
+	bool prev_in_output = false;					//stores if prev_point was handed to the output (the plotter is at prev_point)
+
+	flatten::Point_Batch curve_points;	//reused by every curve, so the points of a curve are computed without allocating
+
+	//settings, see set_max_deviation() and set_motor_distance()
+	static constexpr double default_max_deviation = 1.0 / 40.0;	//one step of the plotter
+	double max_deviation = default_max_deviation;
+	double motor_distance = 0.0;
+	la::Vec2D wall_offset = { 0.0, 0.0 };
+	double line_deviation = 1.0 / 40.0;
+
+	//as long as max_deviation is bigger than 0 (by default one step of the plotter), curves (beziers and arcs) ignore their resolution 
+	//and are split into as many straight lines as needed to keep every line closer than max_deviation to the real curve.
+	//max_deviation is given in board units (mm). setting it to 0 switches back to the fixed resolution.
+	void set_max_deviation(double new_max_deviation);
+
+	//if motor_distance is set to a value > 0, straight lines ignore their resolution and are drawn as a single line.
+	//every line drawn (also the ones of curves) is then split once for the cables by whoever takes the points,
+	//keeping the plotter closer than line_deviation (in mm) to the line, see optimize::Cable_Splitter.
+	//the board is expected to be drawn with its origin at wall_offset on the wall, as seen from the left motor
+	//(the offset_x and offset_y given to the plotter, basheySrc/stepper08.cpp).
+	void set_motor_distance(double new_motor_distance, la::Vec2D new_wall_offset, double new_line_deviation = 1.0 / 40.0);
+
+	//draws the part of the line from the last point given (to save_draw_to() or save_go_to()) to point, which lies inside the view box.
+	//if the line enters the view box, the plotter first goes to where it enters.
+	void save_draw_to(la::Board_Vec point);
+
+	//goes to point if this point resides inside view box (does not draw)
+	void save_go_to(la::Board_Vec point);
 };
 
 
@@ -41,6 +133,32 @@ namespace read {
 	//opens file with name file_name and reads full file in as string
 	std::string string_from_file(const char* file_name);
 
+	//reads the distance between the motors from the config file of the plotter (formatted as "W <width> L <left> R <right>").
+	//if the file can not be read, 0 is returned.
+	double motor_distance_from_config(const char* file_name);
+
+	//maps a file into memory (read only), so it can be read without copying it into a string.
+	//the tokenizer skips comments and treats newlines as whitespace, so the view can be evaluated as is (without preprocess_str()).
+	//throws std::runtime_error if the file can not be opened.
+	class Mapped_File
+	{
+		const char* data = nullptr;	//nullptr for an empty file
+		std::size_t size = 0;
+#ifdef _WIN32
+		void* file_handle = nullptr;
+		void* mapping_handle = nullptr;
+#endif
+
+	public:
+		explicit Mapped_File(const char* file_name);
+		~Mapped_File();
+
+		Mapped_File(const Mapped_File&) = delete;
+		Mapped_File& operator=(const Mapped_File&) = delete;
+
+		std::string_view view() const { return { this->data, this->size }; }
+	};
+
 	//assumes str to hold svg and removes comments (everything between "<!--" and "-->")
 	//also swaps out newlines within quotes to spaces ("...d=\"M100 100 \n L20 30...\"..." becomes "...d=\"M100 100   L20 30...\"...")
 	void preprocess_str(std::string& str);
@@ -73,8 +191,51 @@ namespace read {
 
 	std::string_view name_of(Elem_Type type);
 
-	//just like search_zone.find(find, start) but ignores everything written in between quotes
-	std::size_t find_skip_quotations(std::string_view search_zone, std::string_view find, std::size_t start = 0);
+	//what the tokenizer finds next in the document
+	enum class Token_Type
+	{
+		elem_start,		//"<circle ..." 
+		attribute,		//"cx=\"100\""
+		elem_end,		//"/>" of a start tag closing itself or "</g>"
+		text,			//everything in between elements, that is not only whitespace
+		end,			//if the document is fully read, type "end" is returned
+	};
+
+	struct Token
+	{
+		Token_Type type = Token_Type::end;
+		std::string_view name;	//name of element for elem_start and elem_end, name of attribute for attribute
+		std::string_view value;	//elem_start: all attributes as written in the start tag, attribute: data in between quotes, text: the text itself
+		//example:
+		// "<circle cx=\"100\" r=\"20\"/>" will be split into:
+		// {Token_Type::elem_start, "circle", " cx=\"100\" r=\"20\""}
+		// {Token_Type::attribute, "cx", "100"}
+		// {Token_Type::attribute, "r", "20"}
+		// {Token_Type::elem_end, "circle", ""}
+	};
+
+	//returns next attribute (as in "cx=\"100\"") and shortens view to after that attribute.
+	//if view holds no further attribute, a Token of type end is returned.
+	Token take_next_attribute(std::string_view& view);
+
+	//walks the document exactly once from front to back. each call to next() continues where the last one stopped,
+	//so no part of the document is read more than once (apart from the attributes of a start tag, witch are read twice).
+	//comments, xml declarations and CDATA sections are skipped.
+	class Tokenizer
+	{
+		std::string_view rest;			//part of document behind last token returned
+		std::string_view attributes;	//attributes of last start tag not yet returned as tokens
+		std::string_view open_name;		//name of last start tag
+		bool self_closing = false;		//last start tag is of form "<name ... />" and an elem_end is still to be returned
+
+	public:
+		Tokenizer(std::string_view document);
+
+		Token next();
+
+		//part of the document not yet read
+		std::string_view unread() const;
+	};
 
 	struct Elem_Data
 	{
@@ -85,16 +246,78 @@ namespace read {
 		// {Elem_Type::circle, "cx=\"100\" cy=\"200\" r=\"20\""}
 	};
 
-	//returns view to the part of content describing your attribute
-	//example: std::string_view("cx=\"100\" cy=\"200\" r=\"20\"").get_attribute_data("cx=") 
-	//  yields "100", as this is specified after "cx="
-	//if attr_name is not found, "" is returned
-	std::string_view get_attribute_data(std::string_view search_zone, std::string_view attr_name);
+	//all attributes read by this program. every other attribute is ignored.
+	enum class Attribute
+	{
+		x, y,
+		x1, y1, x2, y2,
+		width, height,
+		cx, cy,
+		r, rx, ry,
+		points,
+		d,
+		transform,
+		view_box,
+
+		unknown,	//every attribute not listed above
+	};
 
-	//multiple commas/ spaces and combinations thereof are read in as a single seperator.
-	//example: from_csv("-1, 30 4  6.35,9") yields { -1.0, 30.0, 4.0, 6.35. 9.0 }
-	//if always_comma is set, csv will not seperate at space or '-', but only at ','.
-	std::vector<double> from_csv(std::string_view csv, bool always_comma = false);
+	//array of all attributes BUT UNKNOWN to be used in range based for loops
+	static const Attribute all_attributes[] = { Attribute::x, Attribute::y, Attribute::x1, Attribute::y1, Attribute::x2, Attribute::y2, 
+		Attribute::width, Attribute::height, Attribute::cx, Attribute::cy, Attribute::r, Attribute::rx, Attribute::ry, 
+		Attribute::points, Attribute::d, Attribute::transform, Attribute::view_box, };
+
+	//returns attribute name as written in svg. example: name_of(Attribute::view_box) yields "viewBox"
+	std::string_view name_of(Attribute attribute);
+
+	//returns Attribute with name (as in "cx"). if name is not listed, Attribute::unknown is returned.
+	Attribute attribute_of(std::string_view name);
+
+	//table of all attributes of one element, build by reading the elements content exactly once.
+	//afterwards every attribute is found without any search.
+	class Attributes
+	{
+		std::string_view values[std::size(all_attributes)];		//values[i] holds data of attribute all_attributes[i] ("" if not given)
+
+	public:
+		Attributes() = default;
+		Attributes(std::string_view content);	//content is expected as in Elem_Data::content
+
+		//example: Attributes("cx=\"100\" cy=\"200\" r=\"20\"")[Attribute::cx] yields "100"
+		std::string_view operator[](Attribute attribute) const;
+	};
+
+	//reads the numbers of a list (as found in path data, points, transform lists or viewBox) one after another, without allocating memory.
+	//multiple commas/ whitespace and combinations thereof are read in as a single seperator.
+	//a '-' also starts a new number, if it does not belong to an exponent: "10-20" holds two numbers, "100e-4" only one.
+	//example: scanning "-1, 30 4  6.35,9" yields -1.0, 30.0, 4.0, 6.35 and 9.0
+	class Number_Scanner
+	{
+		const char* current;	//first character not yet read
+		const char* end;
+
+	public:
+		Number_Scanner(std::string_view csv);
+
+		//skips seperators and reads the following number into result. 
+		//if the next thing after the seperators is not a number (or the end is reached), false is returned.
+		bool next(double& result);
+
+		//reads up to capacity numbers into buffer, returns how many were read
+		std::size_t next(double* buffer, std::size_t capacity);
+
+		//reads a single '0' or '1' (as the flags of an arc in path data, witch do not need a seperator: "a 5 5 0 01 10 10")
+		bool next_flag(double& result);
+
+		//skips seperators and returns the next character without reading it ('\0' if the end is reached)
+		char peek();
+
+		//skips seperators and the following character (as a command letter in path data)
+		void skip_char();
+
+		//part of csv not yet read
+		std::string_view unread() const;
+	};
 
 	//units as specified by w3: https://www.w3.org/TR/SVG11/coords.html#Units
 	enum class Unit
@@ -114,17 +337,77 @@ namespace read {
 
 	static const Unit all_units[] = { Unit::px, Unit::pt, Unit::pc, Unit::mm, Unit::cm, Unit::in };
 
-	//returns Elem_Data of next element and shortens view to after the current element
+	//returns Elem_Type belonging to name (as in "circle"). if name is not listed, Elem_Type::unknown is returned.
+	Elem_Type elem_type_of(std::string_view name);
+
+	//returns Elem_Data of next element and shortens view to after the current element (closing tags are skipped)
 	Elem_Data take_next_elem(std::string_view& view);
 
-	//sets view box and calls functions for elements in svg
-	void evaluate_svg(std::string_view svg_view, double board_width, double board_height);
+	//index of a Node in Document
+	using Node_Index = std::uint32_t;
+	constexpr Node_Index no_node = std::numeric_limits<Node_Index>::max();
 
-	//reads all of fragment
-	void evaluate_fragment(std::string_view fragment, const la::Transform_Matrix& transform);
+	struct Node
+	{
+		Elem_Type type = Elem_Type::unknown;
+		Node_Index first_child = no_node;
+		Node_Index next_sibling = no_node;
+	};
 
-	//returns matrix resulting from transformation attributes of group specified in group attributes
-	la::Transform_Matrix get_transform_matrix(std::string_view group_attributes);
+	//tree of all elements in a document, build with a single pass of the Tokenizer.
+	//all nodes live in one vector (in document order), children are found by following the indices in Node.
+	//elements of type unknown are not stored, their children are added to the closest known ancestor instead.
+	class Document
+	{
+		std::vector<Node> nodes;	//nodes[0] does not belong to an element, but stands for the whole document
+		std::vector<Attributes> attribute_tables;	//attributes of nodes[i] are stored in attribute_tables[i]
+
+	public:
+		Document(std::string_view svg_view);
+
+		const Node& operator[](Node_Index index) const;
+
+		//node of whole document, the outhermost svg element is expected to be its child
+		static constexpr Node_Index root = 0;
+
+		const Attributes& attributes_of(Node_Index index) const;
+	};
+
+	//sets view box of context and calls functions for elements in svg
+	//the points drawn are handed to the sink set in the output buffer of context (or printed, if there is none)
+	void evaluate_svg(Converter_Context& context, std::string_view svg_view, double board_width, double board_height);
+
+	//same as above, but all points drawn are handed to sink
+	template<typename Sink>
+	void evaluate_svg(Converter_Context& context, std::string_view svg_view, double board_width, double board_height, Sink& sink);
+
+	//same as above, draw_to and go_to are called with every point drawn to / gone to
+	template<typename Draw_To, typename Go_To>
+	void evaluate_svg(Converter_Context& context, std::string_view svg_view, double board_width, double board_height, Draw_To& draw_to, Go_To& go_to);
+
+	//same as above, with a new context (default settings) for this document only
+	template<typename Sink>
+	void evaluate_svg(std::string_view svg_view, double board_width, double board_height, Sink& sink);
+	template<typename Draw_To, typename Go_To>
+	void evaluate_svg(std::string_view svg_view, double board_width, double board_height, Draw_To& draw_to, Go_To& go_to);
+
+	//same as evaluate_svg(), but the shapes are flattened on thread_count threads at once, every thread with its own copy of settings.
+	//the shapes are split in tasks (which the threads steal from each other when done), every task is drawn into its own toolpath.
+	//these are appended to toolpath in document order, so the result is the same as evaluating on one thread.
+	void evaluate_svg_parallel(const Converter_Context& settings, std::string_view svg_view, double board_width, double board_height, 
+		Toolpath& toolpath, std::size_t thread_count);
+
+	//same as evaluate_svg(), but the document is read from input (e.g. std::cin of a pipe) in chunks of chunk_size bytes.
+	//every shape is drawn as soon as its start tag is read and the output buffer of context is flushed after it.
+	//only the part of the document not yet evaluated is kept, so memory stays bounded by chunk_size and the longest tag,
+	//no matter how long the document is. the view box is taken from the first svg element (it has to come before all shapes).
+	void evaluate_svg_stream(Converter_Context& context, std::istream& input, double board_width, double board_height, std::size_t chunk_size = 1 << 16);
+
+	//reads all children of node fragment (and recursively their children)
+	void evaluate_fragment(Converter_Context& context, const Document& document, Node_Index fragment, const la::Transform_Matrix& transform);
+
+	//returns matrix resulting from transform_list (the data of a transform attribute, as in "translate(10, 20) scale(2)")
+	la::Transform_Matrix get_transform_matrix(std::string_view transform_list);
 }
 
 
@@ -156,23 +439,6 @@ namespace path {
 		relative,
 	};
 
-	struct Path_Elem_data
-	{
-		//quite exactly analogous to read::Elem_Data
-		std::string_view content;
-		Path_Elem type = Path_Elem::end;
-		Coords_Type coords_type = Coords_Type::absolute;
-	};
-
-	//returns Path_Elem_Data of next element and shortens view to after the current element
-	Path_Elem_data take_next_elem(std::string_view& view);
-
-	//do the drawing of as much bezier curves as data can deliver
-	//current_point is current position of plotter
-	//return where they finnished drawing (the new current_point).
-	la::Vec2D process_quadr_bezier(const la::Transform_Matrix& transform_matrix, Path_Elem_data data, la::Vec2D current_point);
-	la::Vec2D process_cubic_bezier(const la::Transform_Matrix& transform_matrix, Path_Elem_data data, la::Vec2D current_point);
-
 	//control point is given explicitly -> set to expl
 	//control point is to be calculated from the last control point -> set to impl
 	//see here how to calculate: https://www.w3.org/TR/SVG11/paths.html#PathDataCurveCommands
@@ -182,31 +448,73 @@ namespace path {
 		impl,
 	};
 
+	//one command of path data together with its numbers. 
+	//if a letter is followed by multiple sets of numbers, one Path_Command is returned for each set, 
+	//just as if the letter was repeated in front of every set ("M 1 2 3 4" is returned as "M 1 2 L 3 4").
+	struct Path_Command
+	{
+		Path_Elem type = Path_Elem::end;
+		Coords_Type coords_type = Coords_Type::absolute;
+
+		//if all points (but the start) are given explicitly, this flag is set to expl
+		//-> if 'C', 'c', 'Q' or 'q' are read in, control_data is set to explicit,
+		//-> if 'T', 't', 'S' or 's' are read in, control_data is set to implicit
+		Control_Given control_data = Control_Given::expl;
+
+		double args[7] = {};	//only the first few are used, depending on type (an arc needs all 7)
+	};
+
+	//reads path data (the data of a d attribute) exactly once from front to back
+	class Path_Parser
+	{
+		read::Number_Scanner numbers;
+		char letter = '\0';	//letter of the current command, gets repeated as long as numbers follow
+
+	public:
+		Path_Parser(std::string_view path_data);
+
+		//if the path data is fully read (or an error is found), a Path_Command of type end is returned
+		Path_Command next();
+	};
+
 	//if a control point is only given implicitly, it lies on a line with the last control point and the current point.
 	//the distance to the current point is equal to the distance of the last control point and the current point, 
 	//only the direction is opposite.
 	la::Vec2D compute_contol_point(la::Vec2D last_control_point, la::Vec2D mirror);
 
-	struct Bezier_Data
+	//one command of path data with relative coordinates and implicit control points resolved (still in the coordinates of the path)
+	struct Path_Segment
 	{
-		//only numbers, no mor letters. ready as is to be plugged into from_csv()
-		std::string_view content;
-
-		//if all points (but the start) are given explicitly, this flag is set to true
-		//-> if 'C', 'c', 'Q' or 'q' are read in, control_data is set to explicit,
-		//-> if 'T', 't', 'S' or 's' are read in, control_data is set to implicit
-		Control_Given control_data = Control_Given::expl;
-		Coords_Type coords_type = Coords_Type::absolute;
+		Path_Elem type = Path_Elem::end;
+		la::Vec2D start = { 0.0, 0.0 };		//current point in front of the command
+		la::Vec2D control_1 = { 0.0, 0.0 };	//only used by quadr_bezier and cubic_bezier
+		la::Vec2D control_2 = { 0.0, 0.0 };	//only used by cubic_bezier
+		la::Vec2D end = { 0.0, 0.0 };		//current point behind the command (for move the point moved to, for closed the begin of the subpath)
+		Path_Command command;				//as read, an arc is computed from its numbers
 	};
 
-	//returns Bezier_Data specified at start of view & removes prefix of view to start after returned data
-	//if no data is found, content is set to "". 
-	//both quadratic and cubic share this same function
-	Bezier_Data take_next_bezier(std::string_view& view);
+	//reads path data one segment after another, keeping track of the current point, the begin of the current subpath
+	//and the last control point (to mirror implicit control points of smooth curves).
+	//everything walking path data (drawing it or collecting its curves) uses this, so all see the same segments.
+	class Segment_Reader
+	{
+		Path_Parser commands;
+		la::Vec2D current_point = { 0.0, 0.0 };
+		la::Vec2D current_subpath_begin = { 0.0, 0.0 };	//called initial point by w3
+		la::Vec2D last_control_point = { 0.0, 0.0 };	//only meaningful if last_type is a bezier curve
+		Path_Elem last_type = Path_Elem::end;
+
+	public:
+		Segment_Reader(std::string_view path_data);
 
-	//analogous to process_bezier() functions
+		//if the path data is fully read (or an error is found), a Path_Segment of type end is returned
+		Path_Segment next();
+	};
+
+	//do the drawing of the arc in command
+	//current_point is current position of plotter, returned is where the arc ends (the new current_point)
 	//see here how to calculate: https://www.w3.org/TR/SVG11/paths.html#PathDataEllipticalArcCommands
-	la::Vec2D process_arc(const la::Transform_Matrix& transform_matrix, Path_Elem_data data, la::Vec2D current_point);
+	la::Vec2D process_arc(Converter_Context& context, const la::Transform_Matrix& transform_matrix, const Path_Command& command, la::Vec2D current_point);
 }
 
 
@@ -216,27 +524,83 @@ namespace path {
 //although a straight line can already be described by a straight line perfectly, it may also be of advantage to split it, 
 // as the linear interpolation on the plotterside to draw from one point to the nex may suffer from the non-linear nature of the
 // transformation from kartesian coordinates to cable lengths.
+//if the distance of the motors is known (see Converter_Context::set_motor_distance()), straight lines are not split here,
+// but together with all other lines after converting, exactly as much as needed (see optimize::Cable_Splitter).
 //transform in draw() is matrix needed to transform from current coordinate system to board system
+//all points are drawn through context (clipped against its view box and stored in its output buffer)
 namespace draw {
 	constexpr std::size_t default_res = 10;
 
-	void line     (la::Transform_Matrix transform_matrix, std::string_view parameters, std::size_t resolution = default_res);
-	void rect     (la::Transform_Matrix transform_matrix, std::string_view parameters, std::size_t resolution = default_res);
-	void circle   (la::Transform_Matrix transform_matrix, std::string_view parameters, std::size_t resolution = default_res);
-	void ellipse  (la::Transform_Matrix transform_matrix, std::string_view parameters, std::size_t resolution = default_res);
-	void polyline (la::Transform_Matrix transform_matrix, std::string_view parameters, std::size_t resolution = default_res);
-	void polygon  (la::Transform_Matrix transform_matrix, std::string_view parameters, std::size_t resolution = default_res);
-	void path     (la::Transform_Matrix transform_matrix, std::string_view parameters, std::size_t resolution = default_res);
+	void line     (Converter_Context& context, la::Transform_Matrix transform_matrix, const read::Attributes& attributes, std::size_t resolution = default_res);
+	void rect     (Converter_Context& context, la::Transform_Matrix transform_matrix, const read::Attributes& attributes, std::size_t resolution = default_res);
+	void circle   (Converter_Context& context, la::Transform_Matrix transform_matrix, const read::Attributes& attributes, std::size_t resolution = default_res);
+	void ellipse  (Converter_Context& context, la::Transform_Matrix transform_matrix, const read::Attributes& attributes, std::size_t resolution = default_res);
+	void polyline (Converter_Context& context, la::Transform_Matrix transform_matrix, const read::Attributes& attributes, std::size_t resolution = default_res);
+	void polygon  (Converter_Context& context, la::Transform_Matrix transform_matrix, const read::Attributes& attributes, std::size_t resolution = default_res);
+	void path     (Converter_Context& context, la::Transform_Matrix transform_matrix, const read::Attributes& attributes, std::size_t resolution = default_res);
 
 	//the following functions are called mostly from path()
 
 	//arc is part of ellipse between start_angle and start_angle + delta_angle
 	//angles are expected to be in rad
 	//note: a rotated ellipse can not be described as an unrotated one, hence we need to drag the rotation matrix into this function.
-	void arc(const la::Transform_Matrix& transform_matrix, la::Vec2D center, double rx, double ry, double start_angle,
+	void arc(Converter_Context& context, const la::Transform_Matrix& transform_matrix, la::Vec2D center, double rx, double ry, double start_angle,
 		double delta_angle, std::size_t resolution = default_res);
 
-	void linear_bezier(la::Board_Vec start, la::Board_Vec end, std::size_t resolution = default_res);
-	void quadr_bezier(la::Board_Vec start, la::Board_Vec control, la::Board_Vec end, std::size_t resolution = default_res);
-	void cubic_bezier(la::Board_Vec start, la::Board_Vec control_1, la::Board_Vec control_2, la::Board_Vec end, std::size_t resolution = default_res);
+	void linear_bezier(Converter_Context& context, la::Board_Vec start, la::Board_Vec end, std::size_t resolution = default_res);
+	void quadr_bezier(Converter_Context& context, la::Board_Vec start, la::Board_Vec control, la::Board_Vec end, std::size_t resolution = default_res);
+	void cubic_bezier(Converter_Context& context, la::Board_Vec start, la::Board_Vec control_1, la::Board_Vec control_2, la::Board_Vec end, std::size_t resolution = default_res);
+}
+
+
+
+template<typename Sink>
+void Output_Buffer::flush_to(void* sink, const Output_Buffer& buffer)
+{
+	Sink& typed_sink = *static_cast<Sink*>(sink);
+	for (std::size_t i = 0; i < buffer.size; i++) {
+		const la::Board_Vec point(buffer.x[i], buffer.y[i]);
+		if (buffer.pen_down[i]) {
+			typed_sink.draw_to(point);
+		}
+		else {
+			typed_sink.go_to(point);
+		}
+	}
+}
+
+template<typename Sink>
+void read::evaluate_svg(Converter_Context& context, std::string_view svg_view, double board_width, double board_height, Sink& sink)
+{
+	Output_Buffer& output = context.output;
+	output.size = 0;
+	output.sink = &sink;
+	output.flush_sink = &Output_Buffer::flush_to<Sink>;
+
+	read::evaluate_svg(context, svg_view, board_width, board_height);
+	output.flush();
+
+	output.sink = nullptr;
+	output.flush_sink = nullptr;
+}
+
+template<typename Draw_To, typename Go_To>
+void read::evaluate_svg(Converter_Context& context, std::string_view svg_view, double board_width, double board_height, Draw_To& draw_to, Go_To& go_to)
+{
+	Function_Sink<Draw_To, Go_To> sink = { draw_to, go_to };
+	read::evaluate_svg(context, svg_view, board_width, board_height, sink);
+}
+
+template<typename Sink>
+void read::evaluate_svg(std::string_view svg_view, double board_width, double board_height, Sink& sink)
+{
+	Converter_Context context;
+	read::evaluate_svg(context, svg_view, board_width, board_height, sink);
+}
+
+template<typename Draw_To, typename Go_To>
+void read::evaluate_svg(std::string_view svg_view, double board_width, double board_height, Draw_To& draw_to, Go_To& go_to)
+{
+	Converter_Context context;
+	read::evaluate_svg(context, svg_view, board_width, board_height, draw_to, go_to);
 }
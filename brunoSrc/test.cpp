@@ -2,11 +2,17 @@
 #include <cassert>
 #include <cmath>
 #include <functional>
+#include <array>
 #include <iostream>
 #include <fstream>
+#include <chrono>
+#include <vector>
 
 #include "test.hpp"
 #include "svgHandling.hpp"
+#include "flattening.hpp"
+#include "toolpath.hpp"
+#include "optimize.hpp"
 #include "libBMP.h"
 
 
@@ -98,63 +104,99 @@ void BMP::save_as(const char* name)
 
 
 SVG::SVG(const char* file_name, la::Board_Vec min, la::Board_Vec max)
-	:document(file_name)
+	:document(file_name, 0.001)
 {
-	this->document << "<!DOCTYPE html>\n";
-	this->document << "<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"" << min.x << ' ' << min.y << ' ' << max.x - min.x << ' ' << max.y - min.y << "\">\n";
-	this->document << "<path style=\"stroke: #ff0000; stroke-width: 1; fill: none;\" d=\"";
+	this->document.write("<!DOCTYPE html>\n");
+	this->document.write("<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"");
+	this->document.write(min.x);
+	this->document.write(' ');
+	this->document.write(min.y);
+	this->document.write(' ');
+	this->document.write(max.x - min.x);
+	this->document.write(' ');
+	this->document.write(max.y - min.y);
+	this->document.write("\">\n");
+	this->document.write("<path style=\"stroke: #ff0000; stroke-width: 1; fill: none;\" d=\"");
 }
 
 SVG::~SVG()
 {
 	std::cout << "saving output svg...\n";
-	this->document << "\"/>\n</svg>\n";
-	this->document.close();
+	this->document.write("\"/>\n</svg>\n");
 }
 
 void SVG::move_to(la::Board_Vec point)
 {
-	this->document << 'M' << point.x << ' ' << point.y;
+	this->document.write('M');
+	this->document.write(point.x);
+	this->document.write(' ');
+	this->document.write(point.y);
 }
 
 void SVG::draw_to(la::Board_Vec point)
 {
-	this->document << ' ' << point.x << ' ' << point.y;
+	this->document.write(' ');
+	this->document.write(point.x);
+	this->document.write(' ');
+	this->document.write(point.y);
 }
 
 
 
 
-void test::svg_to_bmp(const std::string& svg_str, const char* output_name, double board_width, double board_height, uint16_t mesh_size, double scaling_factor)
+void test::print_statistics(const Toolpath& toolpath)
 {
-	//finding out how often draw_to is called
-	unsigned int amount_points = 0;
-	double distance = 0;
-	la::Board_Vec current_point(0, 0);
-	bool pen_down = false;
-	unsigned int times_pen_moved_down = 0;
-	auto compute_draw_to_values = [&](la::Board_Vec point) {
-		amount_points++; 
-		distance += la::abs(current_point - point);
-		current_point = point;
-		if (!pen_down) {
-			times_pen_moved_down++;
+	const Toolpath::Statistics statistics = toolpath.statistics();
+	std::cout << "total distance the plotter moves is " << statistics.draw_distance + statistics.travel_distance << " mm\n";
+	std::cout << "the pen was moved down " << statistics.pen_downs << " times\n";
+	const unsigned int time_in_seconds = static_cast<unsigned int>(statistics.estimated_seconds());
+	std::cout << "the estimated time to draw is " << time_in_seconds / 60 << " minutes and " << time_in_seconds % 60 << " seconds\n";
+}
+
+void test::optimize_toolpath(Toolpath& toolpath, double simplify_tolerance, double motor_distance, la::Vec2D wall_offset, bool report)
+{
+	//the statistics are only computed for the report
+	auto statistics_of = [report](const Toolpath& toolpath) { return report ? toolpath.statistics() : Toolpath::Statistics{}; };
+
+	if (simplify_tolerance > 0.0) {
+		const std::size_t points_before = toolpath.point_count();
+		toolpath = optimize::simplify(toolpath, simplify_tolerance);
+		if (report) {
+			std::cout << "simplifying reduced the amount of points from " << points_before << " to " << toolpath.point_count() << "\n";
 		}
-		pen_down = true;
-	};
-	auto compute_go_to_values = [&](la::Board_Vec point) {
-		distance += la::abs(current_point - point);
-		current_point = point;
-		pen_down = false;
-	};
-	set_output_functions(compute_draw_to_values, compute_go_to_values);
-	read::evaluate_svg({ svg_str.c_str(), svg_str.length() }, board_width, board_height);
+	}
 
-	std::cout << "total distance the plotter moves is " << distance << " mm\n";
-	std::cout << "the pen was moved down " << times_pen_moved_down << " times\n";
-	const unsigned int time_in_seconds = static_cast<unsigned int>(distance / 4.44 + times_pen_moved_down * 1.0);
-	std::cout << "the estimated time to draw is " << time_in_seconds / 60 << " minutes and " << time_in_seconds % 60 << " seconds\n";
+	const Toolpath::Statistics before_removing = statistics_of(toolpath);
+	toolpath = optimize::remove_overlaps(toolpath);
+	const Toolpath::Statistics before_joining = statistics_of(toolpath);
+	if (report) {
+		std::cout << "removing lines drawn twice reduced the distance drawn by " << before_removing.draw_distance - before_joining.draw_distance << " mm\n";
+	}
+
+	toolpath = optimize::join_polylines(toolpath);
+	const Toolpath::Statistics after_joining = statistics_of(toolpath);
+	if (report) {
+		std::cout << "joining polylines reduced the times the pen is moved down from " << before_joining.pen_downs << " to " << after_joining.pen_downs << "\n";
+	}
+
+	toolpath = optimize::minimize_travel(toolpath);
+	const Toolpath::Statistics after_reordering = statistics_of(toolpath);
+	if (report) {
+		std::cout << "reordering reduced the distance moved with pen up from " << after_joining.travel_distance << " mm to " << after_reordering.travel_distance << " mm\n";
+	}
+
+	if (motor_distance > 0.0) {
+		const std::size_t points_before = toolpath.point_count();
+		toolpath = optimize::split_for_cables(toolpath, motor_distance, wall_offset);
+		if (report) {
+			std::cout << "splitting lines for the cables increased the amount of points from " << points_before << " to " << toolpath.point_count() << "\n";
+		}
+	}
+}
 
+void test::toolpath_to_bmp(const Toolpath& toolpath, const char* output_name, double board_width, double board_height, uint16_t mesh_size, double scaling_factor)
+{
+	const std::size_t amount_points = toolpath.statistics().points_drawn;
 	const double hue_per_point = 1.99 * la::pi / amount_points;	//just stay under 2 * pi, to not risk hue beeing slightly over 2 * pi in last point due to rounding error
 	HSV hsv_color = { 0, 1, 1 };
 
@@ -211,35 +253,19 @@ void test::svg_to_bmp(const std::string& svg_str, const char* output_name, doubl
 
 
 	std::cout << "draw picture..." << std::endl;
-	set_output_functions(draw_to, go_to);
-	read::evaluate_svg({ svg_str.c_str(), svg_str.length() }, board_width, board_height);
+	toolpath.replay(draw_to, go_to);
 
 	std::cout << "save picture as " << output_name << " ..." << std::endl;
 	picture.save_as(output_name);
 }
 
-void test::svg_to_bbf(const std::string& svg_str, const char* output_name, double board_width, double board_height)
+void test::toolpath_to_bbf(const Toolpath& toolpath, const char* output_name, double precision)
 {
-	//opening new bbf file
-	std::ofstream output;
-	output.open(output_name);
-
-	auto go_to = [&](la::Board_Vec point) {
-		output << "0 " << point.x << " " << point.y << "\n";
-	};
-	auto draw_to = [&](la::Board_Vec point) {
-		output << "1 " << point.x << " " << point.y << "\n";
-	};
-
-	std::cout << "draw picture..." << std::endl;
-	set_output_functions(draw_to, go_to);
-	read::evaluate_svg({ svg_str.c_str(), svg_str.length() }, board_width, board_height);
-
-	std::cout << "save picture as " << output_name << " ..." << std::endl;
-	output.close();
+	std::cout << "save bbf as " << output_name << " ..." << std::endl;
+	bbf::write_text(toolpath, output_name, precision);
 }
 
-void test::svg_to_svg(const std::string& svg_str, const char* output_name, double board_width, double board_height)
+void test::toolpath_to_svg(const Toolpath& toolpath, const char* output_name, double board_width, double board_height)
 {
 	SVG output(output_name, la::Board_Vec(0, 0), la::Board_Vec(board_width - 0, board_height - 0));
 
@@ -249,8 +275,7 @@ void test::svg_to_svg(const std::string& svg_str, const char* output_name, doubl
 	auto draw_to = [&](la::Board_Vec point) {
 		output.draw_to(point);
 	};
-	set_output_functions(draw_to, go_to);
-	read::evaluate_svg({ svg_str.c_str(), svg_str.length() }, board_width, board_height);
+	toolpath.replay(draw_to, go_to);
 }
 
 void test::read_string_to_all(const char* input_name, double board_width, double board_height)
@@ -261,9 +286,108 @@ void test::read_string_to_all(const char* input_name, double board_width, double
 	const std::string out_svg_name = std::string("samples/outsvgs/") + std::string(input_name) + std::string("_out.svg");
 
 	std::cout << "\nreading in " << svg_name << " ..." << std::endl;
-	std::string content_str = read::string_from_file(svg_name.c_str());
-	read::preprocess_str(content_str);
-	test::svg_to_bmp(content_str, bmp_name.c_str(), board_width, board_height, 0, 2.2);
-	//test::svg_to_bbf(content_str, bbf_name.c_str(), board_width, board_height);
-	test::svg_to_svg(content_str, out_svg_name.c_str(), board_width, board_height);
+	const read::Mapped_File svg(svg_name.c_str());
+	Toolpath toolpath;
+	read::evaluate_svg(svg.view(), board_width, board_height, toolpath);
+
+	test::optimize_toolpath(toolpath);
+	test::print_statistics(toolpath);
+	test::toolpath_to_bmp(toolpath, bmp_name.c_str(), board_width, board_height, 0, 2.2);
+	//test::toolpath_to_bbf(toolpath, bbf_name.c_str());
+	test::toolpath_to_svg(toolpath, out_svg_name.c_str(), board_width, board_height);
+}
+
+//start, control_1, control_2, end of a cubic bezier curve
+using Cubic_Curve = std::array<la::Board_Vec, 4>;
+
+//collects the cubic curves of all path elements in the subtree of node (in the coordinates of the path, transforms are ignored)
+void collect_cubic_curves(const read::Document& document, read::Node_Index node, std::vector<Cubic_Curve>& curves)
+{
+	for (read::Node_Index child = document[node].first_child; child != read::no_node; child = document[child].next_sibling) {
+		collect_cubic_curves(document, child, curves);
+		if (document[child].type != read::Elem_Type::path) {
+			continue;
+		}
+		//the same segments draw::path() flattens
+		path::Segment_Reader segments(document.attributes_of(child)[read::Attribute::d]);
+		for (path::Path_Segment segment = segments.next(); segment.type != path::Path_Elem::end; segment = segments.next()) {
+			if (segment.type == path::Path_Elem::cubic_bezier) {
+				curves.push_back({ la::Board_Vec(segment.start.x, segment.start.y), la::Board_Vec(segment.control_1.x, segment.control_1.y), 
+					la::Board_Vec(segment.control_2.x, segment.control_2.y), la::Board_Vec(segment.end.x, segment.end.y) });
+			}
+		}
+	}
+}
+
+//calls kernel for every curve (repeated until about min_points points are computed) and returns nanoseconds per computed point
+template<typename Kernel>
+double time_per_point(const std::vector<Cubic_Curve>& curves, std::size_t resolution, std::size_t min_points, Kernel kernel)
+{
+	const std::size_t repetitions = min_points / (curves.size() * resolution) + 1;
+	const auto start = std::chrono::steady_clock::now();
+	for (std::size_t repetition = 0; repetition < repetitions; repetition++) {
+		for (const Cubic_Curve& curve : curves) {
+			kernel(curve, resolution);
+		}
+	}
+	const auto end = std::chrono::steady_clock::now();
+	const double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count();
+	return nanoseconds / (repetitions * curves.size() * resolution);
+}
+
+void test::benchmark_flattening(const char* input_name)
+{
+	const std::string svg_name = std::string("samples/") + std::string(input_name) + std::string(".svg");
+	std::cout << "\nreading in " << svg_name << " ..." << std::endl;
+	const read::Mapped_File svg(svg_name.c_str());
+	const read::Document document(svg.view());
+
+	std::vector<Cubic_Curve> curves;
+	collect_cubic_curves(document, read::Document::root, curves);
+	std::cout << "found " << curves.size() << " cubic bezier curves" << std::endl;
+	if (curves.empty()) {
+		return;
+	}
+
+	la::Board_Vec checksum(0, 0);	//every point is added here (and printed at the end), so the compiler can not skip computing them
+	//the old way of drawing: every point is computed on its own and handed to a std::function
+	const std::function<void(la::Board_Vec)> sink = [&](la::Board_Vec point) { checksum = checksum + point; };
+	auto reference = [&](const Cubic_Curve& curve, std::size_t resolution) {
+		for (std::size_t step = 1; step <= resolution; step++) {
+			const double t = step / static_cast<double>(resolution);
+			const double onet = (1 - t);
+			sink(onet * onet * (onet * curve[0] + 3 * t * curve[1]) + t * t * (3 * onet * curve[2] + t * curve[3]));
+		}
+	};
+	flatten::Point_Batch batch;
+	auto consume = [&]() {
+		for (std::size_t i = 0; i < batch.size; i++) {
+			checksum = checksum + la::Board_Vec(batch.x[i], batch.y[i]);
+		}
+	};
+	auto direct = [&](const Cubic_Curve& curve, std::size_t resolution) {
+		flatten::cubic_direct(curve[0], curve[1], curve[2], curve[3], resolution, batch);
+		consume();
+	};
+	auto forward_differences = [&](const Cubic_Curve& curve, std::size_t resolution) {
+		flatten::cubic_forward_differences(curve[0], curve[1], curve[2], curve[3], resolution, batch);
+		consume();
+	};
+	auto avx2 = [&](const Cubic_Curve& curve, std::size_t resolution) {
+		flatten::cubic_avx2(curve[0], curve[1], curve[2], curve[3], resolution, batch);
+		consume();
+	};
+
+	const std::size_t min_points = 20000000;
+	for (const std::size_t resolution : { draw::default_res, std::size_t(100) }) {
+		std::cout << "resolution " << resolution << " (ns per point):\n";
+		std::cout << "  reference (std::function):  " << time_per_point(curves, resolution, min_points, reference) << "\n";
+		std::cout << "  bernstein (batch):          " << time_per_point(curves, resolution, min_points, direct) << "\n";
+		std::cout << "  forward differences:        " << time_per_point(curves, resolution, min_points, forward_differences) << "\n";
+		std::cout << "  AVX2:                       " << time_per_point(curves, resolution, min_points, avx2) << "\n";
+	}
+	if (!flatten::avx2_available) {
+		std::cout << "(AVX2 is not enabled in this build, flatten::cubic_avx2() used forward differences)\n";
+	}
+	std::cout << "checksum: " << checksum.x << " " << checksum.y << std::endl;
 }
@@ -4,6 +4,9 @@
 #include <fstream>
 
 #include "linearAlgebra.hpp"
+#include "toolpath.hpp"
+#include "optimize.hpp"
+#include "bbfFormat.hpp"
 
 struct RGB
 {
@@ -42,7 +45,7 @@ public:
 //this is not meant as real svg exporter, but just as a way to visualize output data
 class SVG	
 {
-	std::ofstream document;
+	Text_Writer document;
 
 public:
 	//min and max are used to set view box in svg
@@ -55,12 +58,26 @@ public:
 
 namespace test {
 
-	void svg_to_bmp(const std::string& svg_str, const char* output_name, double board_width, double board_height, 
+	//prints distance moved, how often the pen is moved down and the estimated time to draw toolpath
+	void print_statistics(const Toolpath& toolpath);
+
+	//runs the stages of optimize:: on toolpath and prints what they saved (only if report is set)
+	//polylines are only simplified, if simplify_tolerance is bigger than 0 (this also merges the pieces straight lines were split into,
+	//see draw::default_res, which only get split again for the cables, if motor_distance is bigger than 0)
+	//lines are only split for the cables, if motor_distance is bigger than 0 (for the board drawn at wall_offset, see optimize::split_for_cables())
+	void optimize_toolpath(Toolpath& toolpath, double simplify_tolerance = 0.0, double motor_distance = 0.0, la::Vec2D wall_offset = { 0.0, 0.0 }, 
+		bool report = true);
+
+	void toolpath_to_bmp(const Toolpath& toolpath, const char* output_name, double board_width, double board_height, 
 		uint16_t mesh_size, double scaling_factor = 1);
-	void svg_to_bbf(const std::string& svg_str, const char* output_name, double board_width, double board_height);
+	//coordinates are rounded to multiples of precision, see bbf::write_text()
+	void toolpath_to_bbf(const Toolpath& toolpath, const char* output_name, double precision = 1.0 / bbf::steps_per_mm);
 
-	void svg_to_svg(const std::string& svg_str, const char* output_name, double board_width, double board_height);
+	void toolpath_to_svg(const Toolpath& toolpath, const char* output_name, double board_width, double board_height);
 
 	//this function expects a specific folder structure
 	void read_string_to_all(const char* input_name, double board_width, double board_height);
+
+	//times the different kernels of flatten:: on all cubic bezier curves of samples/<input_name>.svg
+	void benchmark_flattening(const char* input_name);
 }
\ No newline at end of file
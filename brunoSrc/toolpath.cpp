@@ -0,0 +1,73 @@
+#include "toolpath.hpp"
+
+#include <algorithm>
+
+void Bounding_Box::add(la::Board_Vec point)
+{
+	this->min.x = std::min(this->min.x, point.x);
+	this->min.y = std::min(this->min.y, point.y);
+	this->max.x = std::max(this->max.x, point.x);
+	this->max.y = std::max(this->max.y, point.y);
+}
+
+void Toolpath::go_to(la::Board_Vec point)
+{
+	this->polyline_starts.push_back(this->xs.size());
+	this->bounding_boxes.emplace_back(point);
+	this->xs.push_back(point.x);
+	this->ys.push_back(point.y);
+}
+
+void Toolpath::draw_to(la::Board_Vec point)
+{
+	if (this->polyline_starts.empty()) {
+		this->go_to(point);
+		return;
+	}
+	this->bounding_boxes.back().add(point);
+	this->xs.push_back(point.x);
+	this->ys.push_back(point.y);
+}
+
+void Toolpath::clear()
+{
+	this->xs.clear();
+	this->ys.clear();
+	this->polyline_starts.clear();
+	this->bounding_boxes.clear();
+}
+
+void Toolpath::append(const Toolpath& other)
+{
+	const std::size_t offset = this->xs.size();
+	this->xs.insert(this->xs.end(), other.xs.begin(), other.xs.end());
+	this->ys.insert(this->ys.end(), other.ys.begin(), other.ys.end());
+	for (const std::size_t start : other.polyline_starts) {
+		this->polyline_starts.push_back(start + offset);
+	}
+	this->bounding_boxes.insert(this->bounding_boxes.end(), other.bounding_boxes.begin(), other.bounding_boxes.end());
+}
+
+double Toolpath::Statistics::estimated_seconds() const
+{
+	return (this->draw_distance + this->travel_distance) / 4.44 + this->pen_downs * 1.0;
+}
+
+Toolpath::Statistics Toolpath::statistics() const
+{
+	Statistics result;
+	la::Board_Vec current(0, 0);
+	for (std::size_t polyline = 0; polyline < this->polyline_count(); polyline++) {
+		const std::size_t begin = this->begin_of(polyline);
+		const std::size_t end = this->end_of(polyline);
+		result.travel_distance += la::abs(this->point(begin) - current);
+		current = this->point(begin);
+		for (std::size_t i = begin + 1; i < end; i++) {
+			result.draw_distance += la::abs(this->point(i) - current);
+			current = this->point(i);
+		}
+		result.points_drawn += end - begin - 1;
+		result.pen_downs += end - begin > 1 ? 1 : 0;
+	}
+	return result;
+}
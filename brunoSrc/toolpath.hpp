@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "linearAlgebra.hpp"
+
+//smallest axis aligned box containing all points added
+struct Bounding_Box
+{
+	la::Board_Vec min;
+	la::Board_Vec max;
+
+	explicit Bounding_Box(la::Board_Vec point) :min(point), max(point) {}
+
+	void add(la::Board_Vec point);
+};
+
+//the result of converting a document: every move of the plotter in the order it is done.
+//the moves are grouped in polylines: the pen is lifted to move to the first point of a polyline (go to),
+//all further points of the polyline are drawn to with the pen down (draw to).
+//the points are stored in structure of arrays layout, every polyline also stores its bounding box.
+//as a toolpath can be used as sink (see Output_Buffer), a document is converted into one by calling read::evaluate_svg(..., toolpath).
+class Toolpath
+{
+	std::vector<double> xs;
+	std::vector<double> ys;
+	std::vector<std::size_t> polyline_starts;	//index of first point of every polyline
+	std::vector<Bounding_Box> bounding_boxes;	//one per polyline
+
+public:
+	//sink interface
+	void go_to(la::Board_Vec point);
+	void draw_to(la::Board_Vec point);	//if no polyline was started before, the point is gone to instead
+
+	void clear();
+
+	//appends all polylines of other after the ones of this toolpath
+	void append(const Toolpath& other);
+
+	std::size_t point_count() const { return this->xs.size(); }
+	std::size_t polyline_count() const { return this->polyline_starts.size(); }
+
+	//points of polyline are point(begin_of(polyline)) to point(end_of(polyline) - 1)
+	std::size_t begin_of(std::size_t polyline) const { return this->polyline_starts[polyline]; }
+	std::size_t end_of(std::size_t polyline) const;
+	la::Board_Vec point(std::size_t index) const { return la::Board_Vec(this->xs[index], this->ys[index]); }
+	const Bounding_Box& bounding_box_of(std::size_t polyline) const { return this->bounding_boxes[polyline]; }
+
+	//calls sink.go_to() with the first point of every polyline and sink.draw_to() with the other points
+	template<typename Sink>
+	void replay(Sink& sink) const;
+
+	//same as above, but calls the functions draw_to and go_to
+	template<typename Draw_To, typename Go_To>
+	void replay(Draw_To& draw_to, Go_To& go_to) const;
+
+	struct Statistics
+	{
+		std::size_t points_drawn = 0;	//amount of draw to moves
+		std::size_t pen_downs = 0;		//amount of polylines with at least one point drawn to
+		double draw_distance = 0.0;		//distance moved with pen down
+		double travel_distance = 0.0;	//distance moved with pen up (starting at (0, 0))
+
+		//time the plotter needs for all moves (at roughly 4.44 mm/s) and to lower the pen (roughly a second each time)
+		double estimated_seconds() const;
+	};
+
+	Statistics statistics() const;
+};
+
+
+
+
+inline std::size_t Toolpath::end_of(std::size_t polyline) const
+{
+	return polyline + 1 < this->polyline_starts.size() ? this->polyline_starts[polyline + 1] : this->xs.size();
+}
+
+template<typename Sink>
+void Toolpath::replay(Sink& sink) const
+{
+	for (std::size_t polyline = 0; polyline < this->polyline_count(); polyline++) {
+		const std::size_t begin = this->begin_of(polyline);
+		const std::size_t end = this->end_of(polyline);
+		sink.go_to(this->point(begin));
+		for (std::size_t i = begin + 1; i < end; i++) {
+			sink.draw_to(this->point(i));
+		}
+	}
+}
+
+template<typename Draw_To, typename Go_To>
+void Toolpath::replay(Draw_To& draw_to, Go_To& go_to) const
+{
+	for (std::size_t polyline = 0; polyline < this->polyline_count(); polyline++) {
+		const std::size_t begin = this->begin_of(polyline);
+		const std::size_t end = this->end_of(polyline);
+		go_to(this->point(begin));
+		for (std::size_t i = begin + 1; i < end; i++) {
+			draw_to(this->point(i));
+		}
+	}
+}